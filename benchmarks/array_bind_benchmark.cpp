@@ -0,0 +1,169 @@
+// Looks up and updates a set of task ids three ways: one statement per
+// id, through a temporary table of ids, and with the ids bound as one
+// array read through wx_array. Prints the best of five runs of each.
+//
+// Usage: array_bind_benchmark [ids] [tasks]
+//
+// The ids, 10k by default, are drawn at random from the tasks, 100k by
+// default, which one user owns in an in-memory database.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "database_manager.h"
+#include "category_manager.h"
+#include "user_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int USER_ID = 1;
+const int RUNS = 5;
+
+void AddTasks(wxSQLite3Database* db, int count) {
+    db->ExecuteUpdate("BEGIN");
+    wxSQLite3Statement stmt = db->PrepareStatement(
+        "INSERT INTO tasks (title, description, due_day, priority, completed, user_id) "
+        "VALUES (?, '', ?, ?, 0, ?)");
+    for (int i = 0; i < count; ++i) {
+        stmt.Bind(1, wxString::Format("Task %d", i));
+        stmt.Bind(2, 19000 + i % 730);
+        stmt.Bind(3, i % 5 + 1);
+        stmt.Bind(4, USER_ID);
+        stmt.ExecuteUpdate();
+        stmt.Reset();
+    }
+    db->ExecuteUpdate("COMMIT");
+}
+
+// Sums the priorities of the tasks read, so that every row is used
+int SelectLoop(wxSQLite3Database* db, const std::vector<int>& ids) {
+    int sum = 0;
+    wxSQLite3Statement stmt = db->PrepareStatement("SELECT priority FROM tasks WHERE id = ?");
+    for (int id : ids) {
+        stmt.Bind(1, id);
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        if (set.NextRow()) {
+            sum += set.GetAsInt(0);
+        }
+    }
+    return sum;
+}
+
+// How EditTasks passed its ids before wx_array
+int SelectTempTable(wxSQLite3Database* db, const std::vector<int>& ids) {
+    int sum = 0;
+    db->ExecuteUpdate("CREATE TEMP TABLE bench_ids (id INTEGER PRIMARY KEY)");
+    db->ExecuteUpdate("BEGIN");
+    wxSQLite3Statement insert = db->PrepareStatement("INSERT OR IGNORE INTO bench_ids VALUES (?)");
+    for (int id : ids) {
+        insert.Bind(1, id);
+        insert.ExecuteUpdate();
+        insert.Reset();
+    }
+    db->ExecuteUpdate("COMMIT");
+    {
+        wxSQLite3ResultSet set = db->ExecuteQuery(
+            "SELECT priority FROM tasks WHERE id IN (SELECT id FROM temp.bench_ids)");
+        while (set.NextRow()) {
+            sum += set.GetAsInt(0);
+        }
+    }
+    db->ExecuteUpdate("DROP TABLE temp.bench_ids");
+    return sum;
+}
+
+int SelectArray(wxSQLite3Database* db, const std::vector<int>& ids) {
+    int sum = 0;
+    wxSQLite3Statement stmt = db->PrepareStatement("SELECT priority FROM tasks WHERE id IN wx_array(?)");
+    stmt.Bind(1, ids);
+    wxSQLite3ResultSet set = stmt.ExecuteQuery();
+    while (set.NextRow()) {
+        sum += set.GetAsInt(0);
+    }
+    return sum;
+}
+
+int UpdateLoop(wxSQLite3Database* db, const std::vector<int>& ids) {
+    int changed = 0;
+    db->ExecuteUpdate("BEGIN");
+    wxSQLite3Statement stmt = db->PrepareStatement("UPDATE tasks SET priority = 6 - priority WHERE id = ?");
+    for (int id : ids) {
+        stmt.Bind(1, id);
+        changed += stmt.ExecuteUpdate();
+        stmt.Reset();
+    }
+    db->ExecuteUpdate("COMMIT");
+    return changed;
+}
+
+int UpdateArray(wxSQLite3Database* db, const std::vector<int>& ids) {
+    db->ExecuteUpdate("BEGIN");
+    wxSQLite3Statement stmt = db->PrepareStatement(
+        "UPDATE tasks SET priority = 6 - priority WHERE id IN wx_array(?)");
+    stmt.Bind(1, ids);
+    int changed = stmt.ExecuteUpdate();
+    stmt.Reset();
+    db->ExecuteUpdate("COMMIT");
+    return changed;
+}
+
+void Run(const char* name, const std::function<int()>& code) {
+    double best = 0;
+    int result = 0;
+    for (int run = 0; run < RUNS; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        result = code();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    std::printf("%-22s %8.1f ms  (%d)\n", name, best, result);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    int idCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int taskCount = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+    DatabaseManager manager;
+    manager.SetShowErrors(false);
+    if (!manager.Connect(":memory:")) {
+        return 1;
+    }
+    UserManager users(manager.GetDatabase());
+    users.InitializeUserTable();
+    CategoryManager categories(manager.GetDatabase());
+    categories.InitializeCategoryTable();
+    manager.SetCategoryManager(&categories);
+
+    wxSQLite3Database* db = manager.GetDatabase();
+    AddTasks(db, taskCount);
+
+    std::mt19937 random(24);
+    std::vector<int> ids(idCount);
+    for (int& id : ids) {
+        id = static_cast<int>(random() % taskCount) + 1;
+    }
+
+    // Printed after the connection's own logging. The figure in
+    // parentheses is the sum of priorities read or the rows updated; the
+    // loops count a repeated id each time, IN counts its task once.
+    std::printf("\n%d random ids, %d tasks, best of %d\n", idCount, taskCount, RUNS);
+    Run("SELECT, loop", [&] { return SelectLoop(db, ids); });
+    Run("SELECT, temp table", [&] { return SelectTempTable(db, ids); });
+    Run("SELECT, wx_array", [&] { return SelectArray(db, ids); });
+    Run("UPDATE, loop", [&] { return UpdateLoop(db, ids); });
+    Run("UPDATE, wx_array", [&] { return UpdateArray(db, ids); });
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Reads a task CSV export with CsvReader and with the line tokenizer the
+// import used before it, and prints the throughput of each.
+//
+// Usage: csv_reader_benchmark [rows]
+//
+// The file has the export's columns, with quoted titles and descriptions
+// but no commas or line breaks inside them, which the old path could
+// not read. Both paths turn every field into a wxString, as the import
+// does; the best of three runs is printed.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include <wx/tokenzr.h>
+#include <wx/txtstrm.h>
+#include <wx/wfstream.h>
+#include "csv_reader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+const char* CSV_FILE = "csv_reader_benchmark.csv";
+const int FIELDS = 7;
+const int RUNS = 3;
+
+void WriteCsv(long rows) {
+    std::ofstream csv(CSV_FILE, std::ios::binary);
+    csv << "ID,Title,Description,Due Date,Priority,Category,Completed\n";
+    for (long i = 0; i < rows; ++i) {
+        csv << i << ",\"Task " << i << " \"\"draft\"\"\",\"Notes for task " << i
+            << " in short\",2025-" << (i % 12 + 1) << "-" << (i % 28 + 1) << ","
+            << (i % 5 + 1) << ",Work," << (i % 3 == 0 ? "Yes" : "No") << "\n";
+    }
+}
+
+wxString Unquote(wxString field) {
+    if (field.StartsWith("\"") && field.EndsWith("\"")) {
+        field = field.SubString(1, field.Length() - 2);
+    }
+    field.Replace("\"\"", "\"");
+    return field;
+}
+
+// The import before CsvReader: a line at a time, split on every comma
+size_t ReadWithTokenizer() {
+    wxFileInputStream input(CSV_FILE);
+    wxTextInputStream text(input);
+    size_t characters = 0;
+
+    text.ReadLine();
+    while (!input.Eof()) {
+        wxString line = text.ReadLine();
+        if (line.IsEmpty()) {
+            continue;
+        }
+        wxStringTokenizer tokenizer(line, ",", wxTOKEN_RET_EMPTY_ALL);
+        for (int i = 0; i < FIELDS; ++i) {
+            characters += Unquote(tokenizer.GetNextToken()).Length();
+        }
+    }
+    return characters;
+}
+
+size_t ReadWithCsvReader() {
+    wxFileInputStream input(CSV_FILE);
+    CsvReader reader(input);
+    size_t characters = 0;
+
+    reader.NextRecord();
+    while (reader.NextRecord()) {
+        if (reader.IsBlankRecord()) {
+            continue;
+        }
+        for (int i = 0; i < FIELDS; ++i) {
+            characters += reader.GetFieldAsString(i).Length();
+        }
+    }
+    return characters;
+}
+
+void Run(const char* name, const std::function<size_t()>& read, double megabytes, long rows) {
+    double best = 0;
+    size_t characters = 0;
+    for (int run = 0; run < RUNS; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        characters = read();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    std::printf("%-12s %8.1f ms %8.1f MB/s %10.0f rows/s  (%zu characters)\n",
+                name, best * 1000, megabytes / best, rows / best, characters);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    long rows = argc > 1 ? std::atol(argv[1]) : 200000;
+    WriteCsv(rows);
+    double megabytes = std::ifstream(CSV_FILE, std::ios::binary | std::ios::ate).tellg() / 1e6;
+    std::printf("%ld rows, %.1f MB\n", rows, megabytes);
+
+    Run("tokenizer", ReadWithTokenizer, megabytes, rows);
+    Run("CsvReader", ReadWithCsvReader, megabytes, rows);
+
+    std::remove(CSV_FILE);
+    return 0;
+}
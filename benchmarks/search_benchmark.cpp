@@ -0,0 +1,175 @@
+// Times DatabaseManager::SearchTasks through the FTS5 index and through
+// the LIKE query it falls back to, on a generated task list.
+//
+// Usage: search_benchmark [tasks]
+//
+// The tasks, 1M by default, belong to one user and have titles such as
+// "Task tango 1234" and two-word descriptions drawn from the same words.
+// The LIKE figures come from the same file with tasks_fts dropped and
+// the connection reopened, which is how SearchTasks runs on a SQLite
+// built without FTS5. The best of three runs of each search is printed.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "database_manager.h"
+#include "category_manager.h"
+#include "user_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const char* DB_FILE = "search_benchmark.db";
+const int USER_ID = 1;
+const int RUNS = 3;
+
+const char* const WORDS[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel", "india",
+    "juliett", "kilo", "lima", "mike", "november", "oscar", "papa", "quebec", "romeo",
+    "sierra", "tango", "uniform", "victor", "whiskey", "xray", "yankee", "zulu"
+};
+const int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+struct Query {
+    const char* text;
+    TaskSearch::Field field;
+};
+
+const Query QUERIES[] = {
+    {"4242", TaskSearch::ALL_FIELDS},
+    {"tango 1234", TaskSearch::ALL_FIELDS},
+    {"zulu", TaskSearch::ALL_FIELDS},
+    {"zulu", TaskSearch::TITLE},
+};
+const int QUERY_COUNT = sizeof(QUERIES) / sizeof(QUERIES[0]);
+
+struct Timing {
+    double ms;
+    size_t found;
+};
+
+void RemoveDatabase() {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::remove((std::string(DB_FILE) + suffix).c_str());
+    }
+}
+
+bool Connect(DatabaseManager& manager) {
+    DatabaseTuning tuning;
+    DatabaseTuning::FromName("balanced", tuning);
+    manager.SetShowErrors(false);
+    if (!manager.Connect(DB_FILE, tuning)) {
+        return false;
+    }
+    UserManager users(manager.GetDatabase());
+    return users.InitializeUserTable();
+}
+
+void AddTasks(DatabaseManager& manager, int count) {
+    wxSQLite3Database* db = manager.GetDatabase();
+    db->ExecuteUpdate("BEGIN");
+    wxSQLite3Statement stmt = db->PrepareStatement(
+        "INSERT INTO tasks (title, description, due_day, priority, completed, user_id) "
+        "VALUES (?, ?, ?, ?, ?, ?)");
+    for (int i = 0; i < count; ++i) {
+        stmt.Bind(1, wxString::Format("Task %s %d", WORDS[i % WORD_COUNT], i));
+        stmt.Bind(2, wxString::Format("%s %s notes", WORDS[i * 7 % WORD_COUNT], WORDS[i * 11 % WORD_COUNT]));
+        stmt.Bind(3, 19000 + i % 730);
+        stmt.Bind(4, i % 5 + 1);
+        stmt.Bind(5, i % 3 == 0 ? 1 : 0);
+        stmt.Bind(6, USER_ID);
+        stmt.ExecuteUpdate();
+        stmt.Reset();
+    }
+    db->ExecuteUpdate("COMMIT");
+}
+
+std::vector<Timing> TimeQueries(DatabaseManager& manager) {
+    std::vector<Timing> timings;
+    for (const Query& query : QUERIES) {
+        TaskSearch search;
+        search.text = query.text;
+        search.field = query.field;
+        search.priority = 0;
+        search.fromDay = NO_DUE_DATE;
+        search.toDay = NO_DUE_DATE;
+        search.categoryId = -1;
+        search.includeCompleted = true;
+
+        Timing timing = {0, 0};
+        for (int run = 0; run < RUNS; ++run) {
+            TaskStore results;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (!manager.SearchTasks(USER_ID, search, results)) {
+                std::exit(1);
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            timing.ms = run == 0 ? ms : std::min(timing.ms, ms);
+            timing.found = results.GetCount();
+        }
+        timings.push_back(timing);
+    }
+    return timings;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    RemoveDatabase();
+
+    std::vector<Timing> fullText;
+    double buildSeconds;
+    {
+        DatabaseManager manager;
+        if (!Connect(manager) || !manager.HasFullTextSearch()) {
+            std::fprintf(stderr, "FTS5 is not available\n");
+            return 1;
+        }
+        CategoryManager categories(manager.GetDatabase());
+        categories.InitializeCategoryTable();
+        manager.SetCategoryManager(&categories);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        AddTasks(manager, count);
+        buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fullText = TimeQueries(manager);
+
+        // The triggers that fill tasks_fts go with it; nothing is written
+        // after this
+        manager.GetDatabase()->ExecuteUpdate("DROP TABLE tasks_fts");
+    }
+
+    std::vector<Timing> like;
+    {
+        DatabaseManager manager;
+        if (!Connect(manager) || manager.HasFullTextSearch()) {
+            return 1;
+        }
+        CategoryManager categories(manager.GetDatabase());
+        categories.InitializeCategoryTable();
+        manager.SetCategoryManager(&categories);
+
+        like = TimeQueries(manager);
+    }
+    RemoveDatabase();
+
+    // Printed at the end, after the connection's own logging
+    std::printf("\n%d tasks, inserted and indexed in %.1f s\n", count, buildSeconds);
+    std::printf("%-22s %10s %8s %10s %8s\n", "query", "FTS5 ms", "found", "LIKE ms", "found");
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        wxString name = wxString::Format("%s%s", QUERIES[i].text,
+                                         QUERIES[i].field == TaskSearch::TITLE ? " (title)" : "");
+        std::printf("%-22s %10.1f %8zu %10.1f %8zu\n", name.ToStdString().c_str(),
+                    fullText[i].ms, fullText[i].found, like[i].ms, like[i].found);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Measures the heap held by loaded tasks: the std::vector<Task> that
+// GetAllTasks returns, and the TaskStore that the task grid lists.
+//
+// Usage: task_memory_benchmark [tasks]
+//
+// The tasks, 100k by default, belong to one user in an in-memory
+// database and are spread over eight categories, with one in nine left
+// without a category. The heap is read with glibc's mallinfo2, counting
+// mmapped blocks as well, so this benchmark needs glibc 2.33 or later.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "database_manager.h"
+#include "category_manager.h"
+#include "user_manager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+const int USER_ID = 1;
+
+const char* const CATEGORIES[][2] = {
+    {"Work", "#336699"}, {"Personal", "#669933"}, {"Shopping", "#CC9933"},
+    {"Health", "#CC3333"}, {"Finance", "#339999"}, {"Family", "#9966CC"},
+    {"Errands", "#666666"}, {"Learning", "#FFCC00"}
+};
+const int CATEGORY_COUNT = sizeof(CATEGORIES) / sizeof(CATEGORIES[0]);
+
+size_t HeapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+void Report(const char* name, size_t before, size_t after, int tasks) {
+    double bytes = static_cast<double>(after) - static_cast<double>(before);
+    std::printf("%-22s %10.2f MB %8.1f bytes/task\n", name, bytes / 1e6, bytes / tasks);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+    if (HeapInUse() == 0) {
+        std::fprintf(stderr, "This benchmark needs glibc 2.33 or later\n");
+        return 1;
+    }
+
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    DatabaseManager manager;
+    manager.SetShowErrors(false);
+    if (!manager.Connect(":memory:")) {
+        return 1;
+    }
+    UserManager users(manager.GetDatabase());
+    users.InitializeUserTable();
+    CategoryManager categories(manager.GetDatabase());
+    categories.InitializeCategoryTable();
+    manager.SetCategoryManager(&categories);
+
+    std::vector<int> categoryIds;
+    for (const auto& category : CATEGORIES) {
+        categoryIds.push_back(categories.AddCategory(category[0], category[1], "", USER_ID));
+    }
+    manager.GetDatabase()->ExecuteUpdate("BEGIN");
+    for (int i = 0; i < count; ++i) {
+        int categoryId = i % (CATEGORY_COUNT + 1) == CATEGORY_COUNT ? -1 : categoryIds[i % (CATEGORY_COUNT + 1)];
+        if (!manager.AddTask(wxString::Format("Task %d", i), wxString::Format("Notes for task %d", i),
+                             19000 + i % 730, i % 5 + 1, categoryId, USER_ID)) {
+            return 1;
+        }
+    }
+    manager.GetDatabase()->ExecuteUpdate("COMMIT");
+
+    // Load once and drop the result, so that the statement cache and the
+    // interned category records exist before measuring
+    manager.GetAllTasks(USER_ID);
+
+    size_t before = HeapInUse();
+    std::vector<Task> tasks = manager.GetAllTasks(USER_ID);
+    size_t afterTasks = HeapInUse();
+    if (static_cast<int>(tasks.size()) != count) {
+        return 1;
+    }
+    std::vector<Task>().swap(tasks);
+
+    size_t beforeStore = HeapInUse();
+    TaskPage page;
+    if (!manager.GetTasksPage(USER_ID, TaskFilter(), nullptr, count, page)) {
+        return 1;
+    }
+    size_t afterStore = HeapInUse();
+
+    // Printed at the end, after the connection's own logging
+    std::printf("\n%d tasks, %d categories; sizeof(Task) = %zu, sizeof(wxString) = %zu\n",
+                count, CATEGORY_COUNT, sizeof(Task), sizeof(wxString));
+    Report("std::vector<Task>", before, afterTasks, count);
+    Report("TaskStore", beforeStore, afterStore, count);
+    return 0;
+}
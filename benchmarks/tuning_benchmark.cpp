@@ -0,0 +1,125 @@
+// Inserts tasks through DatabaseManager::AddTask under each connection
+// tuning profile, and under SQLite's defaults as used before profiles
+// existed, and prints the inserts per second of each.
+//
+// Usage: tuning_benchmark [single-rows] [batched-rows]
+//
+// Single rows are committed one at a time, as edits made in the main
+// window were; batched rows are committed 1000 to a transaction, as the
+// CSV import does. The database is created in the current directory, so
+// run it on the disk to be measured: the durable and default figures are
+// bound by its fsync.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "database_manager.h"
+#include "category_manager.h"
+#include "user_manager.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const char* DB_FILE = "tuning_benchmark.db";
+const int BATCH_ROWS = 1000;
+
+void RemoveDatabase() {
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::remove((std::string(DB_FILE) + suffix).c_str());
+    }
+}
+
+// The connection as it was opened before tuning profiles
+DatabaseTuning SqliteDefaults() {
+    DatabaseTuning tuning;
+    tuning.name = "defaults";
+    tuning.journalMode = "DELETE";
+    tuning.synchronous = "FULL";
+    tuning.cacheSize = -2000;
+    tuning.mmapSize = 0;
+    tuning.tempStore = "DEFAULT";
+    tuning.busyTimeout = 0;
+    return tuning;
+}
+
+// Inserts rows tasks, batch to a transaction, and returns inserts per second
+double Insert(DatabaseManager& manager, int rows, int batch) {
+    wxSQLite3Database* db = manager.GetDatabase();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rows; ++i) {
+        if (batch > 1 && i % batch == 0) {
+            db->ExecuteUpdate("BEGIN");
+        }
+        if (!manager.AddTask(wxString::Format("Task %d", i), "Benchmark task",
+                             19000 + i % 365, i % 5 + 1, -1, 1)) {
+            std::exit(1);
+        }
+        if (batch > 1 && (i % batch == batch - 1 || i == rows - 1)) {
+            db->ExecuteUpdate("COMMIT");
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return rows / seconds;
+}
+
+struct Result {
+    DatabaseTuning tuning;
+    double single;      // Inserts per second, one row per transaction
+    double batched;     // Inserts per second, BATCH_ROWS per transaction
+};
+
+Result Run(const DatabaseTuning& tuning, int singleRows, int batchedRows) {
+    RemoveDatabase();
+    Result result;
+    result.tuning = tuning;
+    {
+        DatabaseManager manager;
+        manager.SetShowErrors(false);
+        if (!manager.Connect(DB_FILE, tuning)) {
+            std::exit(1);
+        }
+        UserManager users(manager.GetDatabase());
+        users.InitializeUserTable();
+        CategoryManager categories(manager.GetDatabase());
+        categories.InitializeCategoryTable();
+        manager.SetCategoryManager(&categories);
+
+        result.single = Insert(manager, singleRows, 1);
+        result.batched = Insert(manager, batchedRows, BATCH_ROWS);
+    }
+    RemoveDatabase();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    int singleRows = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int batchedRows = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+    std::vector<Result> results;
+    results.push_back(Run(SqliteDefaults(), singleRows, batchedRows));
+    for (const char* name : {"durable", "balanced", "bulk"}) {
+        DatabaseTuning tuning;
+        DatabaseTuning::FromName(name, tuning);
+        results.push_back(Run(tuning, singleRows, batchedRows));
+    }
+
+    // Printed at the end, after the connection's own logging
+    std::printf("\nInserts/s: %d single-row transactions, %d rows in batches of %d\n",
+                singleRows, batchedRows, BATCH_ROWS);
+    std::printf("%-10s %-7s %-7s %12s %12s\n", "profile", "journal", "sync", "single", "batched");
+    for (const Result& result : results) {
+        std::printf("%-10s %-7s %-7s %12.0f %12.0f\n", result.tuning.name.ToStdString().c_str(),
+                    result.tuning.journalMode.ToStdString().c_str(),
+                    result.tuning.synchronous.ToStdString().c_str(), result.single, result.batched);
+    }
+    return 0;
+}
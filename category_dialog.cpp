@@ -92,7 +92,7 @@ void CategoryDialog::OnSaveButton(wxCommandEvent& event) {
     
     if (categoryId == -1) {
         // Add new category
-        success = categoryManager->AddCategory(name, colorStr, description, userId);
+        success = categoryManager->AddCategory(name, colorStr, description, userId) > 0;
     }
     else {
         // Update existing category
@@ -1,6 +1,33 @@
 #include "category_manager.h"
+#include <iostream>
 
-CategoryManager::CategoryManager(wxSQLite3Database* database) : db(database) {
+namespace {
+
+// Parses "#RRGGBB", the form the category dialog and the importer store.
+// wxColour::Set would also take colour names, but looks them up in the
+// colour database, which only the UI thread may use.
+bool ParseColor(const wxString& text, wxUint32& rgb) {
+    if (text.length() != 7 || text[0] != '#') {
+        return false;
+    }
+    for (size_t i = 1; i < text.length(); ++i) {
+        wxUniChar c = text[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
+            return false;
+        }
+    }
+    unsigned long value;
+    if (!text.Mid(1).ToULong(&value, 16)) {
+        return false;
+    }
+    rgb = static_cast<wxUint32>(value);
+    return true;
+}
+
+} // namespace
+
+CategoryManager::CategoryManager(wxSQLite3Database* database)
+    : db(database), indexedUserId(-1), nameIndexValid(false) {
     InitializeCategoryTable();
 }
 
@@ -28,7 +55,7 @@ bool CategoryManager::InitializeCategoryTable() {
     }
 }
 
-bool CategoryManager::AddCategory(const wxString& name, const wxString& color, 
+int CategoryManager::AddCategory(const wxString& name, const wxString& color, 
                                 const wxString& description, int userId) {
     try {
         wxSQLite3Statement stmt = db->PrepareStatement(
@@ -42,11 +69,17 @@ bool CategoryManager::AddCategory(const wxString& name, const wxString& color,
         stmt.Bind(4, userId);
         
         stmt.ExecuteUpdate();
-        return true;
+        int categoryId = static_cast<int>(db->GetLastRowId());
+        
+        if (nameIndexValid && indexedUserId == userId) {
+            nameIndex.emplace(name, categoryId);
+        }
+        
+        return categoryId;
     }
     catch (wxSQLite3Exception& e) {
         wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
-        return false;
+        return -1;
     }
 }
 
@@ -63,6 +96,8 @@ bool CategoryManager::UpdateCategory(int categoryId, const wxString& name,
         stmt.Bind(4, categoryId);
         
         stmt.ExecuteUpdate();
+        nameIndexValid = false;
+        infoCache.erase(categoryId);
         return true;
     }
     catch (wxSQLite3Exception& e) {
@@ -92,6 +127,8 @@ bool CategoryManager::DeleteCategory(int categoryId) {
       
       // Commit the transaction
       db->ExecuteUpdate("COMMIT");
+      nameIndexValid = false;
+      infoCache.erase(categoryId);
       
       return true;
   }
@@ -124,6 +161,11 @@ std::vector<Category> CategoryManager::GetAllCategories(int userId) {
             category.description = resultSet.GetAsString(3);
             category.userId = resultSet.GetAsInt(4);
             
+            // Warm the display records for the task listing
+            if (infoCache.find(category.id) == infoCache.end()) {
+                infoCache.emplace(category.id, MakeCategoryInfo(category.id, category.name, category.color));
+            }
+            
             categories.push_back(category);
         }
     }
@@ -161,3 +203,104 @@ Category* CategoryManager::GetCategoryById(int categoryId) {
     
     return nullptr;
 }
+
+bool CategoryManager::BuildNameIndex(int userId) {
+    nameIndex.clear();
+    nameIndexValid = false;
+    
+    try {
+        wxSQLite3Statement stmt = db->PrepareStatement(
+            "SELECT id, name FROM categories "
+            "WHERE user_id = ? OR user_id IS NULL "
+            "ORDER BY id"
+        );
+        
+        stmt.Bind(1, userId);
+        wxSQLite3ResultSet resultSet = stmt.ExecuteQuery();
+        
+        while (resultSet.NextRow()) {
+            // The oldest category wins when names are duplicated
+            nameIndex.emplace(resultSet.GetAsString(1), resultSet.GetAsInt(0));
+        }
+    }
+    catch (wxSQLite3Exception& e) {
+        wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
+        return false;
+    }
+    
+    indexedUserId = userId;
+    nameIndexValid = true;
+    return true;
+}
+
+int CategoryManager::FindCategoryId(const wxString& name, int userId) {
+    if (!nameIndexValid || indexedUserId != userId) {
+        if (!BuildNameIndex(userId)) {
+            return -1;
+        }
+    }
+    
+    auto it = nameIndex.find(name);
+    return it != nameIndex.end() ? it->second : -1;
+}
+
+void CategoryManager::InvalidateCaches() {
+    nameIndexValid = false;
+    infoCache.clear();
+}
+
+CategoryInfoPtr CategoryManager::MakeCategoryInfo(int id, const wxString& name, const wxString& color) {
+    auto info = std::make_shared<CategoryInfo>();
+    info->id = id;
+    info->name = name;
+    info->rgb = 0xFFFFFF;
+    info->hasColor = ParseColor(color.IsEmpty() ? wxString("#FFFFFF") : color, info->rgb);
+    
+    // Pick the text colour with the better contrast
+    int red = (info->rgb >> 16) & 0xFF;
+    int green = (info->rgb >> 8) & 0xFF;
+    int blue = info->rgb & 0xFF;
+    int brightness = (red * 299 + green * 587 + blue * 114) / 1000;
+    info->darkText = brightness > 128;
+    
+    return info;
+}
+
+CategoryInfoPtr CategoryManager::GetNoCategoryInfo() {
+    static const CategoryInfoPtr noCategory = MakeCategoryInfo(-1, "No Category", "#FFFFFF");
+    return noCategory;
+}
+
+CategoryInfoPtr CategoryManager::GetCategoryInfo(int categoryId) {
+    if (categoryId <= 0) {
+        return GetNoCategoryInfo();
+    }
+    
+    auto it = infoCache.find(categoryId);
+    if (it != infoCache.end()) {
+        return it->second;
+    }
+    
+    CategoryInfoPtr info;
+    try {
+        wxSQLite3Statement stmt = db->PrepareStatement(
+            "SELECT name, color FROM categories WHERE id = ?"
+        );
+        
+        stmt.Bind(1, categoryId);
+        wxSQLite3ResultSet resultSet = stmt.ExecuteQuery();
+        
+        if (!resultSet.NextRow()) {
+            return GetNoCategoryInfo();
+        }
+        info = MakeCategoryInfo(categoryId, resultSet.GetAsString(0), resultSet.GetAsString(1));
+    }
+    catch (wxSQLite3Exception& e) {
+        std::cerr << "Error loading category " << categoryId << ": "
+                  << e.GetMessage().ToStdString() << std::endl;
+        return GetNoCategoryInfo();
+    }
+    
+    infoCache.emplace(categoryId, info);
+    return info;
+}
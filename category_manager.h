@@ -2,9 +2,12 @@
 #define CATEGORY_MANAGER_H
 
 #include <wx/wx.h>
+#include <wx/hashmap.h>
 #include "wxsqlite3/wxsqlite3.h"
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <memory>
 
 // Category data structure
 struct Category {
@@ -15,10 +18,38 @@ struct Category {
     int userId;  // Owner of the category
 };
 
+// Display data of a category, shared by every task that references it.
+// Records are immutable; editing a category interns a new record, and
+// tasks loaded earlier keep the old one until they are reloaded.
+// Colours are kept as plain 0xRRGGBB values: pool readers build records
+// on worker threads, where wxColour must not be created or destroyed, so
+// the UI makes its wxColour from these when it draws.
+struct CategoryInfo {
+    int id;             // -1 for the "No Category" record
+    wxString name;
+    bool hasColor;      // False if the stored colour does not parse
+    wxUint32 rgb;       // Background colour, 0xRRGGBB
+    bool darkText;      // Black text reads better on rgb than white
+};
+typedef std::shared_ptr<const CategoryInfo> CategoryInfoPtr;
+
 class CategoryManager {
 private:
     wxSQLite3Database* db;
 
+    // Name -> id index of the categories visible to one user, built on
+    // first lookup and kept current by AddCategory
+    std::unordered_map<wxString, int, wxStringHash, wxStringEqual> nameIndex;
+    int indexedUserId;
+    bool nameIndexValid;
+
+    bool BuildNameIndex(int userId);
+
+    // Interned display records by category id, filled on first lookup
+    std::unordered_map<int, CategoryInfoPtr> infoCache;
+
+    static CategoryInfoPtr MakeCategoryInfo(int id, const wxString& name, const wxString& color);
+
 public:
     CategoryManager(wxSQLite3Database* database);
     ~CategoryManager();
@@ -27,7 +58,8 @@ public:
     bool InitializeCategoryTable();
     
     // Category management
-    bool AddCategory(const wxString& name, const wxString& color, 
+    // Returns the id of the new category, or -1 on failure
+    int AddCategory(const wxString& name, const wxString& color, 
                     const wxString& description, int userId);
     bool UpdateCategory(int categoryId, const wxString& name, 
                        const wxString& color, const wxString& description);
@@ -36,6 +68,17 @@ public:
     // Category retrieval
     std::vector<Category> GetAllCategories(int userId);
     Category* GetCategoryById(int categoryId);
+
+    // Id of the category with this exact name visible to userId, or -1
+    int FindCategoryId(const wxString& name, int userId);
+    // Drops the name index and the interned records, e.g. after rolling
+    // back a transaction that added categories; both refill on demand
+    void InvalidateCaches();
+
+    // Shared display record of a category; the "No Category" record for
+    // ids <= 0 and for categories that no longer exist
+    CategoryInfoPtr GetCategoryInfo(int categoryId);
+    static CategoryInfoPtr GetNoCategoryInfo();
 };
 
 #endif // CATEGORY_MANAGER_H
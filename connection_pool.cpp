@@ -0,0 +1,113 @@
+#include "connection_pool.h"
+#include <iostream>
+#include <utility>
+
+// ConnectionPool::Reader implementation
+ConnectionPool::Reader::Reader(Reader&& other) noexcept
+    : pool(other.pool), entry(other.entry) {
+    other.pool = nullptr;
+    other.entry = nullptr;
+}
+
+ConnectionPool::Reader& ConnectionPool::Reader::operator=(Reader&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool = other.pool;
+        entry = other.entry;
+        other.pool = nullptr;
+        other.entry = nullptr;
+    }
+    return *this;
+}
+
+void ConnectionPool::Reader::Release() {
+    if (entry != nullptr) {
+        pool->Return(entry);
+        pool = nullptr;
+        entry = nullptr;
+    }
+}
+
+// ConnectionPool implementation
+ConnectionPool::ConnectionPool(DatabaseManager* writer) : writer(writer) {
+}
+
+ConnectionPool::~ConnectionPool() {
+}
+
+bool ConnectionPool::Open(size_t readers) {
+    try {
+        wxSQLite3ResultSet set = writer->GetDatabase()->ExecuteQuery("PRAGMA journal_mode");
+        if (set.NextRow() && set.GetAsString(0).CmpNoCase("wal") != 0) {
+            std::cout << "Journal mode is not WAL; readers will wait for writes" << std::endl;
+        }
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+    }
+
+    for (size_t i = 0; i < readers; ++i) {
+        std::unique_ptr<Entry> entry(new Entry());
+        // Readers run off the UI thread, where message boxes cannot be shown
+        entry->connection.SetShowErrors(false);
+        entry->connection.GetDatabase()->SetProfiler(writer->GetDatabase()->GetProfiler());
+        if (!entry->connection.ConnectReader(writer->GetPath(), writer->GetTuning())) {
+            break;
+        }
+
+        entry->categories.reset(new CategoryManager(entry->connection.GetDatabase()));
+        entry->connection.SetCategoryManager(entry->categories.get());
+
+        idle.push_back(entry.get());
+        entries.push_back(std::move(entry));
+    }
+
+    std::cout << "Opened " << entries.size() << " reader connections" << std::endl;
+    return !entries.empty();
+}
+
+void ConnectionPool::SetProfiler(wxSQLite3Profiler* profiler) {
+    // SQLite serializes this with statements running on the reader
+    for (const std::unique_ptr<Entry>& entry : entries) {
+        entry->connection.GetDatabase()->SetProfiler(profiler);
+    }
+}
+
+ConnectionPool::Reader ConnectionPool::AcquireReader() {
+    if (entries.empty()) {
+        return Reader();
+    }
+
+    Entry* entry;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        returned.wait(lock, [this] { return !idle.empty(); });
+        entry = idle.back();
+        idle.pop_back();
+    }
+
+    // Category edits are made on the writer; drop what this reader cached
+    entry->categories->InvalidateCaches();
+    try {
+        entry->connection.GetDatabase()->ExecuteUpdate("BEGIN");
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+    }
+    return Reader(this, entry);
+}
+
+void ConnectionPool::Return(Entry* entry) {
+    wxSQLite3Database* db = entry->connection.GetDatabase();
+    try {
+        if (!db->GetAutoCommit()) {
+            db->ExecuteUpdate("COMMIT");
+        }
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(entry);
+    }
+    returned.notify_one();
+}
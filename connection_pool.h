@@ -0,0 +1,87 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <wx/wx.h>
+#include "database_manager.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// One writer and a fixed set of reader connections to the same database.
+//
+// The writer is the application's DatabaseManager, which the UI thread,
+// UserManager and CategoryManager keep using for every write. Readers
+// are opened with query_only and lent to background threads one at a
+// time. A lease runs in a read transaction, so with the WAL journal all
+// of its queries see the snapshot taken by its first read: a reader never
+// waits for the writer, never holds it up, and never sees half of a
+// transaction.
+class ConnectionPool {
+private:
+    struct Entry {
+        DatabaseManager connection;
+        std::unique_ptr<CategoryManager> categories;
+    };
+
+public:
+    static const size_t DEFAULT_READERS = 2;
+
+    // A reader on loan; goes back to the pool when destroyed
+    class Reader {
+    public:
+        Reader() : pool(nullptr), entry(nullptr) {}
+        Reader(Reader&& other) noexcept;
+        Reader& operator=(Reader&& other) noexcept;
+        ~Reader() { Release(); }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        explicit operator bool() const { return entry != nullptr; }
+        DatabaseManager& operator*() const { return entry->connection; }
+        DatabaseManager* operator->() const { return &entry->connection; }
+
+        // Ends the read transaction and returns the connection
+        void Release();
+
+    private:
+        friend class ConnectionPool;
+
+        ConnectionPool* pool;
+        Entry* entry;
+
+        Reader(ConnectionPool* pool, Entry* entry) : pool(pool), entry(entry) {}
+    };
+
+    explicit ConnectionPool(DatabaseManager* writer);
+    // Every Reader must have been released
+    ~ConnectionPool();
+
+    // Opens the readers like the writer; call once, on the UI thread.
+    // Returns false when none could be opened.
+    bool Open(size_t readers = DEFAULT_READERS);
+    size_t GetReaderCount() const { return entries.size(); }
+
+    DatabaseManager* GetWriter() const { return writer; }
+
+    // Readers start with the writer's profiler; this changes it for all
+    // of them, in use or not
+    void SetProfiler(wxSQLite3Profiler* profiler);
+
+    // Waits for a free reader and starts its read transaction; an empty
+    // Reader when the pool has none
+    Reader AcquireReader();
+
+private:
+    DatabaseManager* writer;
+    std::vector<std::unique_ptr<Entry>> entries;
+
+    std::mutex mutex;               // Guards idle
+    std::condition_variable returned;
+    std::vector<Entry*> idle;
+
+    void Return(Entry* entry);
+};
+
+#endif // CONNECTION_POOL_H
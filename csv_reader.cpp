@@ -0,0 +1,196 @@
+#include "csv_reader.h"
+#include <cstring>
+
+CsvReader::CsvReader(wxInputStream& input, size_t bufferSize)
+    : input(input), buffer(bufferSize > 0 ? bufferSize : DEFAULT_BUFFER_SIZE),
+      begin(0), end(0), eof(false), malformed(false), recordNumber(0), bytesRead(0) {
+}
+
+wxString CsvReader::GetFieldAsString(size_t index) const {
+    if (index >= fields.size()) {
+        return wxString();
+    }
+    return wxString::FromUTF8(fields[index].data(), fields[index].size());
+}
+
+bool CsvReader::Fill() {
+    if (eof) {
+        return false;
+    }
+
+    // Keep the unconsumed tail at the front; grow only when a single
+    // record does not fit in the buffer
+    if (begin > 0) {
+        memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+
+    input.Read(buffer.data() + end, buffer.size() - end);
+    size_t count = input.LastRead();
+    if (count == 0) {
+        eof = true;
+        return false;
+    }
+
+    end += count;
+    return true;
+}
+
+bool CsvReader::FindRecordEnd(size_t& recordEnd, size_t& nextBegin) {
+    // Scan for the first line feed outside quotes. An escaped quote ("")
+    // leaves and re-enters the quoted state, so only the quotes need to
+    // be counted here; they are interpreted by SplitRecord.
+    size_t scanned = 0;
+    bool inQuotes = false;
+
+    for (;;) {
+        const char* data = buffer.data();
+        const char* p = data + begin + scanned;
+        const char* last = data + end;
+        const char* lineEnd = nullptr;
+
+        while (p < last) {
+            if (inQuotes) {
+                const char* quote = static_cast<const char*>(memchr(p, '"', last - p));
+                if (quote == nullptr) {
+                    p = last;
+                    break;
+                }
+                p = quote + 1;
+                inQuotes = false;
+                continue;
+            }
+
+            if (lineEnd == nullptr || lineEnd < p) {
+                lineEnd = static_cast<const char*>(memchr(p, '\n', last - p));
+            }
+            const char* stop = lineEnd != nullptr ? lineEnd : last;
+            const char* quote = static_cast<const char*>(memchr(p, '"', stop - p));
+
+            if (quote != nullptr) {
+                p = quote + 1;
+                inQuotes = true;
+            } else if (lineEnd != nullptr) {
+                recordEnd = lineEnd - data;
+                nextBegin = recordEnd + 1;
+                return true;
+            } else {
+                p = last;
+            }
+        }
+
+        scanned = p - (data + begin);
+
+        if (!Fill()) {
+            // The last record may not end in a line feed
+            if (begin == end) {
+                return false;
+            }
+            recordEnd = end;
+            nextBegin = end;
+            return true;
+        }
+    }
+}
+
+void CsvReader::SplitRecord(char* data, size_t length) {
+    fields.clear();
+    malformed = false;
+
+    char* p = data;
+    char* last = data + length;
+
+    for (;;) {
+        if (p < last && *p == '"') {
+            // Quoted field: unescape in place, the result is never longer
+            char* start = p;
+            char* out = p;
+            bool closed = false;
+            ++p;
+
+            while (p < last) {
+                char* quote = static_cast<char*>(memchr(p, '"', last - p));
+                char* stop = quote != nullptr ? quote : last;
+                if (out != p) {
+                    memmove(out, p, stop - p);
+                }
+                out += stop - p;
+                p = stop;
+
+                if (quote == nullptr) {
+                    break;
+                }
+                ++p;
+                if (p < last && *p == '"') {
+                    *out++ = '"';
+                    ++p;
+                } else {
+                    closed = true;
+                    break;
+                }
+            }
+
+            if (!closed) {
+                malformed = true;
+            }
+
+            // Text between the closing quote and the next comma is kept
+            while (p < last && *p != ',') {
+                malformed = true;
+                *out++ = *p++;
+            }
+
+            fields.emplace_back(start, out - start);
+        } else {
+            char* comma = static_cast<char*>(memchr(p, ',', last - p));
+            char* stop = comma != nullptr ? comma : last;
+            if (memchr(p, '"', stop - p) != nullptr) {
+                malformed = true;
+            }
+            fields.emplace_back(p, stop - p);
+            p = stop;
+        }
+
+        if (p == last) {
+            break;
+        }
+        ++p; // Skip the comma
+    }
+}
+
+bool CsvReader::NextRecord() {
+    if (recordNumber == 0) {
+        // Skip a UTF-8 byte order mark
+        while (end - begin < 3 && Fill()) {
+        }
+        if (end - begin >= 3 && memcmp(buffer.data() + begin, "\xEF\xBB\xBF", 3) == 0) {
+            begin += 3;
+            bytesRead += 3;
+        }
+    }
+
+    size_t recordEnd;
+    size_t nextBegin;
+    if (!FindRecordEnd(recordEnd, nextBegin)) {
+        fields.clear();
+        malformed = false;
+        return false;
+    }
+
+    char* data = buffer.data() + begin;
+    size_t length = recordEnd - begin;
+    if (length > 0 && data[length - 1] == '\r') {
+        length--;
+    }
+
+    SplitRecord(data, length);
+
+    bytesRead += nextBegin - begin;
+    begin = nextBegin;
+    recordNumber++;
+    return true;
+}
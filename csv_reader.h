@@ -0,0 +1,60 @@
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <wx/wx.h>
+#include <wx/stream.h>
+#include <string_view>
+#include <vector>
+
+// Streaming RFC 4180 CSV reader.
+//
+// Reads the input in large chunks and yields one record at a time.
+// Quoted fields may contain commas, line breaks and "" escaped quotes;
+// records may end in LF or CRLF, and a leading UTF-8 BOM is skipped.
+//
+// Fields are returned as views into the reader's buffer, unescaped in
+// place, so reading a record does not allocate. The views are only valid
+// until the next call to NextRecord().
+class CsvReader {
+public:
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    explicit CsvReader(wxInputStream& input, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    // Advances to the next record; returns false at the end of the input
+    bool NextRecord();
+
+    size_t GetFieldCount() const { return fields.size(); }
+    std::string_view GetField(size_t index) const { return fields[index]; }
+    // Decodes a UTF-8 field; empty for an index past the last field
+    wxString GetFieldAsString(size_t index) const;
+
+    // True if the current record is a blank line
+    bool IsBlankRecord() const { return fields.size() == 1 && fields[0].empty(); }
+    // True if the current record had stray quotes or an unterminated
+    // quoted field; its fields hold a best-effort reading of the text
+    bool IsMalformed() const { return malformed; }
+
+    // 1-based number of the current record
+    size_t GetRecordNumber() const { return recordNumber; }
+    // Bytes of input consumed up to the end of the current record
+    wxFileOffset GetBytesRead() const { return bytesRead; }
+
+private:
+    wxInputStream& input;
+    std::vector<char> buffer;
+    size_t begin;       // Start of the unconsumed data in buffer
+    size_t end;         // End of the valid data in buffer
+    bool eof;
+
+    std::vector<std::string_view> fields;
+    bool malformed;
+    size_t recordNumber;
+    wxFileOffset bytesRead;
+
+    bool Fill();
+    bool FindRecordEnd(size_t& recordEnd, size_t& nextBegin);
+    void SplitRecord(char* data, size_t length);
+};
+
+#endif // CSV_READER_H
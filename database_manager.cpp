@@ -0,0 +1,1376 @@
+#include "database_manager.h"
+#include <wx/fileconf.h>
+#include <wx/tokenzr.h>
+#include <wx/timer.h>
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+wxString ToString(std::string_view text) {
+    return text.empty() ? wxString() : wxString::FromUTF8(text.data(), text.size());
+}
+
+// PRAGMA arguments cannot be bound, so config values are checked against
+// the keywords SQLite accepts before they are pasted into the statement
+bool IsOneOf(const wxString& value, const char* const* allowed) {
+    for (; *allowed != nullptr; ++allowed) {
+        if (value.CmpNoCase(*allowed) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* const JOURNAL_MODES[] = { "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF", nullptr };
+const char* const SYNCHRONOUS_MODES[] = { "OFF", "NORMAL", "FULL", "EXTRA", nullptr };
+const char* const TEMP_STORES[] = { "DEFAULT", "FILE", "MEMORY", nullptr };
+
+void ReadKeyword(wxFileConfig& config, const wxString& key, const char* const* allowed, wxString& value) {
+    wxString configured;
+    if (!config.Read(key, &configured) || configured.IsEmpty()) {
+        return;
+    }
+
+    if (IsOneOf(configured, allowed)) {
+        value = configured.Upper();
+    } else {
+        std::cerr << "Ignoring invalid database setting " << key.ToStdString()
+                  << "=" << configured.ToStdString() << std::endl;
+    }
+}
+
+// Schema migrations, applied in order to bring PRAGMA user_version up to
+// the latest version. Each step runs in its own transaction together with
+// the version bump, so an interrupted upgrade resumes where it stopped.
+// Append new steps at the end; never edit or reorder released ones.
+// A step that needs an optional SQLite module is skipped, with the version
+// still bumped, when the library was built without it.
+struct Migration {
+    int version;
+    const char* description;
+    const char* sql;
+    const char* module;     // Required SQLite module, or nullptr
+};
+
+const Migration MIGRATIONS[] = {
+    { 1, "Index tasks by owner, status, due date and category",
+      // GetAllTasks: WHERE user_id = ? ORDER BY due_date, priority DESC
+      "CREATE INDEX IF NOT EXISTS idx_tasks_user_due "
+      "ON tasks(user_id, due_date, priority DESC);"
+      // Pending-only listing and status counts: WHERE user_id = ? AND completed = ?
+      "CREATE INDEX IF NOT EXISTS idx_tasks_user_completed_due "
+      "ON tasks(user_id, completed, due_date, priority DESC);"
+      // CategoryManager::DeleteCategory: WHERE category_id = ?
+      "CREATE INDEX IF NOT EXISTS idx_tasks_category ON tasks(category_id);" },
+    { 2, "Keep per-user task counts in task_stats",
+      // Maintained by the triggers below; see CheckTaskStats
+      "CREATE TABLE IF NOT EXISTS task_stats ("
+      "user_id INTEGER PRIMARY KEY, "
+      "total INTEGER NOT NULL DEFAULT 0, "
+      "completed INTEGER NOT NULL DEFAULT 0);"
+      "CREATE TRIGGER IF NOT EXISTS trg_tasks_stats_insert AFTER INSERT ON tasks BEGIN "
+      "INSERT INTO task_stats (user_id, total, completed) "
+      "SELECT NEW.user_id, 1, CASE WHEN NEW.completed THEN 1 ELSE 0 END "
+      "WHERE NEW.user_id IS NOT NULL "
+      "ON CONFLICT(user_id) DO UPDATE SET "
+      "total = total + 1, completed = completed + excluded.completed; "
+      "END;"
+      "CREATE TRIGGER IF NOT EXISTS trg_tasks_stats_delete AFTER DELETE ON tasks BEGIN "
+      "UPDATE task_stats SET total = total - 1, "
+      "completed = completed - CASE WHEN OLD.completed THEN 1 ELSE 0 END "
+      "WHERE user_id = OLD.user_id; "
+      "END;"
+      "CREATE TRIGGER IF NOT EXISTS trg_tasks_stats_update AFTER UPDATE OF completed, user_id ON tasks BEGIN "
+      "UPDATE task_stats SET total = total - 1, "
+      "completed = completed - CASE WHEN OLD.completed THEN 1 ELSE 0 END "
+      "WHERE user_id = OLD.user_id; "
+      "INSERT INTO task_stats (user_id, total, completed) "
+      "SELECT NEW.user_id, 1, CASE WHEN NEW.completed THEN 1 ELSE 0 END "
+      "WHERE NEW.user_id IS NOT NULL "
+      "ON CONFLICT(user_id) DO UPDATE SET "
+      "total = total + 1, completed = completed + excluded.completed; "
+      "END;"
+      "DELETE FROM task_stats;"
+      "INSERT INTO task_stats (user_id, total, completed) "
+      "SELECT user_id, COUNT(*), SUM(CASE WHEN completed THEN 1 ELSE 0 END) "
+      "FROM tasks WHERE user_id IS NOT NULL GROUP BY user_id;" },
+    { 3, "Store due dates as day numbers",
+      // Rebuild tasks with an INTEGER due_day (days since 1970-01-01) in
+      // place of the TEXT due_date. Text that does not start with a valid
+      // YYYY-MM-DD date becomes NULL; the julianday() round trip rejects
+      // days past the end of the month. Dropping the old table drops its
+      // indexes and triggers, so they are created again for the new column,
+      // and its sqlite_sequence row, so the AUTOINCREMENT high-water mark is
+      // carried over first; otherwise the ids of deleted tasks are reused.
+      "CREATE TABLE tasks_new ("
+      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+      "title TEXT NOT NULL, "
+      "description TEXT, "
+      "due_day INTEGER, "
+      "priority INTEGER, "
+      "completed INTEGER DEFAULT 0, "
+      "category_id INTEGER, "
+      "user_id INTEGER, "
+      "FOREIGN KEY(category_id) REFERENCES categories(id), "
+      "FOREIGN KEY(user_id) REFERENCES users(id));"
+      "INSERT INTO tasks_new (id, title, description, due_day, priority, completed, category_id, user_id) "
+      "SELECT id, title, description, "
+      "CASE WHEN date(julianday(substr(due_date, 1, 10))) = substr(due_date, 1, 10) "
+      "THEN CAST(julianday(substr(due_date, 1, 10)) - 2440587.5 AS INTEGER) END, "
+      "priority, completed, category_id, user_id FROM tasks;"
+      "DELETE FROM sqlite_sequence WHERE name = 'tasks_new';"
+      "INSERT INTO sqlite_sequence (name, seq) SELECT 'tasks_new', seq FROM sqlite_sequence WHERE name = 'tasks';"
+      "DROP TABLE tasks;"
+      "ALTER TABLE tasks_new RENAME TO tasks;"
+      "CREATE INDEX idx_tasks_user_due ON tasks(user_id, due_day, priority DESC);"
+      "CREATE INDEX idx_tasks_user_completed_due ON tasks(user_id, completed, due_day, priority DESC);"
+      "CREATE INDEX idx_tasks_category ON tasks(category_id);"
+      "CREATE TRIGGER trg_tasks_stats_insert AFTER INSERT ON tasks BEGIN "
+      "INSERT INTO task_stats (user_id, total, completed) "
+      "SELECT NEW.user_id, 1, CASE WHEN NEW.completed THEN 1 ELSE 0 END "
+      "WHERE NEW.user_id IS NOT NULL "
+      "ON CONFLICT(user_id) DO UPDATE SET "
+      "total = total + 1, completed = completed + excluded.completed; "
+      "END;"
+      "CREATE TRIGGER trg_tasks_stats_delete AFTER DELETE ON tasks BEGIN "
+      "UPDATE task_stats SET total = total - 1, "
+      "completed = completed - CASE WHEN OLD.completed THEN 1 ELSE 0 END "
+      "WHERE user_id = OLD.user_id; "
+      "END;"
+      "CREATE TRIGGER trg_tasks_stats_update AFTER UPDATE OF completed, user_id ON tasks BEGIN "
+      "UPDATE task_stats SET total = total - 1, "
+      "completed = completed - CASE WHEN OLD.completed THEN 1 ELSE 0 END "
+      "WHERE user_id = OLD.user_id; "
+      "INSERT INTO task_stats (user_id, total, completed) "
+      "SELECT NEW.user_id, 1, CASE WHEN NEW.completed THEN 1 ELSE 0 END "
+      "WHERE NEW.user_id IS NOT NULL "
+      "ON CONFLICT(user_id) DO UPDATE SET "
+      "total = total + 1, completed = completed + excluded.completed; "
+      "END;" },
+    { 4, "Index task titles and descriptions for full-text search",
+      // External-content FTS5 index: the text stays in tasks and only the
+      // index is stored. The triggers mirror every change of the two
+      // columns; a migration that rebuilds tasks must create them again.
+      "CREATE VIRTUAL TABLE tasks_fts USING fts5("
+      "title, description, content='tasks', content_rowid='id', "
+      "tokenize='unicode61 remove_diacritics 2');"
+      "CREATE TRIGGER trg_tasks_fts_insert AFTER INSERT ON tasks BEGIN "
+      "INSERT INTO tasks_fts (rowid, title, description) "
+      "VALUES (NEW.id, NEW.title, NEW.description); "
+      "END;"
+      "CREATE TRIGGER trg_tasks_fts_delete AFTER DELETE ON tasks BEGIN "
+      "INSERT INTO tasks_fts (tasks_fts, rowid, title, description) "
+      "VALUES ('delete', OLD.id, OLD.title, OLD.description); "
+      "END;"
+      "CREATE TRIGGER trg_tasks_fts_update AFTER UPDATE OF title, description ON tasks BEGIN "
+      "INSERT INTO tasks_fts (tasks_fts, rowid, title, description) "
+      "VALUES ('delete', OLD.id, OLD.title, OLD.description); "
+      "INSERT INTO tasks_fts (rowid, title, description) "
+      "VALUES (NEW.id, NEW.title, NEW.description); "
+      "END;"
+      "INSERT INTO tasks_fts (tasks_fts) VALUES ('rebuild');",
+      "fts5" },
+};
+
+// Per-user counts recomputed from tasks, as the task_stats triggers should
+// have left them
+const char* ACTUAL_TASK_STATS =
+    "SELECT user_id, COUNT(*) AS total, "
+    "SUM(CASE WHEN completed THEN 1 ELSE 0 END) AS completed "
+    "FROM tasks WHERE user_id IS NOT NULL GROUP BY user_id";
+
+const char* TASK_COLUMNS =
+    "SELECT t.id, t.title, t.description, t.due_day, t.priority, t.completed, "
+    "t.category_id "
+    "FROM tasks t ";
+
+// Listing layout: no description, see TaskRowReader
+const char* TASK_LIST_COLUMNS =
+    "SELECT t.id, t.title, t.due_day, t.priority, t.completed, t.category_id "
+    "FROM tasks t ";
+
+// A mutated row in TaskRowReader::Read's layout plus user_id, for
+// RETURNING and for reading the row before an update
+const char* CHANGED_TASK_COLUMNS =
+    "id, title, description, due_day, priority, completed, category_id, user_id ";
+
+const char* TASK_ORDER = "ORDER BY t.due_day, t.priority DESC, t.id ";
+
+// WHERE clause of a task listing. Rows after a key are those with a later
+// due date, or the same due date and a lower priority, or the same due
+// date and priority and a higher id; NULL due dates sort first.
+wxString TaskListingWhere(const TaskFilter& filter, const TaskKey* afterKey) {
+    wxString where = "WHERE t.user_id = ? ";
+
+    if (!filter.includeCompleted) {
+        where += "AND t.completed = 0 ";
+    }
+
+    if (afterKey != nullptr) {
+        if (afterKey->dueDay == NO_DUE_DATE) {
+            where += "AND (t.due_day IS NOT NULL OR "
+                     "t.priority < ? OR (t.priority = ? AND t.id > ?)) ";
+        } else {
+            // The redundant lower bound lets SQLite seek the index
+            where += "AND t.due_day >= ? AND (t.due_day > ? OR "
+                     "t.priority < ? OR (t.priority = ? AND t.id > ?)) ";
+        }
+    }
+
+    return where;
+}
+
+// Binds the parameters of TaskListingWhere; returns the next free index
+int BindTaskListing(wxSQLite3Statement& stmt, int userId, const TaskKey* afterKey) {
+    int index = 1;
+    stmt.Bind(index++, userId);
+
+    if (afterKey != nullptr) {
+        if (afterKey->dueDay != NO_DUE_DATE) {
+            stmt.Bind(index++, afterKey->dueDay);
+            stmt.Bind(index++, afterKey->dueDay);
+        }
+        stmt.Bind(index++, afterKey->priority);
+        stmt.Bind(index++, afterKey->priority);
+        stmt.Bind(index++, afterKey->id);
+    }
+
+    return index;
+}
+
+// FTS5 query matching every word of text as a prefix in the searched
+// columns. Words are quoted so that FTS5 operators and punctuation typed
+// by the user are taken literally.
+wxString FullTextQuery(const wxString& text, TaskSearch::Field field) {
+    wxString terms;
+    wxStringTokenizer tokens(text, " \t\r\n", wxTOKEN_STRTOK);
+    while (tokens.HasMoreTokens()) {
+        wxString word = tokens.GetNextToken();
+        word.Replace("\"", "\"\"");
+        if (!terms.IsEmpty()) {
+            terms += " ";
+        }
+        terms += "\"" + word + "\"*";
+    }
+
+    switch (field) {
+        case TaskSearch::TITLE:       return "title : (" + terms + ")";
+        case TaskSearch::DESCRIPTION: return "description : (" + terms + ")";
+        default:                      return terms;
+    }
+}
+
+int ReadDueDay(const wxSQLite3ResultSet& set, int column) {
+    return set.IsNull(column) ? NO_DUE_DATE : set.GetAsInt(column);
+}
+
+// Binds a day number, or NULL for NO_DUE_DATE
+void BindDueDay(wxSQLite3Statement& stmt, int index, int dueDay) {
+    if (dueDay == NO_DUE_DATE) {
+        stmt.BindNull(index);
+    } else {
+        stmt.Bind(index, dueDay);
+    }
+}
+
+void ReadTaskKey(const wxSQLite3ResultSet& set, int dueDayCol, int priorityCol, int idCol, TaskKey& key) {
+    key.dueDay = ReadDueDay(set, dueDayCol);
+    key.priority = set.GetAsInt(priorityCol);
+    key.id = set.GetAsInt(idCol);
+}
+
+} // namespace
+
+// TaskRowReader implementation
+void TaskRowReader::Read(const wxSQLite3ResultSet& set, int userId, Task& task) {
+    task.id = set.GetAsInt(0);
+    task.title = ToString(set.GetAsStringView(1));
+    task.description = ToString(set.GetAsStringView(2));
+    task.dueDay = ReadDueDay(set, 3);
+    task.priority = set.GetAsInt(4);
+    task.completed = set.GetAsInt(5) != 0;
+    task.userId = userId;
+
+    task.categoryId = set.IsNull(6) ? -1 : set.GetAsInt(6);
+    task.category = categoryManager != nullptr
+        ? categoryManager->GetCategoryInfo(task.categoryId)
+        : CategoryManager::GetNoCategoryInfo();
+}
+
+void TaskRowReader::Append(const wxSQLite3ResultSet& set, int userId, TaskStore& store) {
+    int categoryId = set.IsNull(5) ? -1 : set.GetAsInt(5);
+    CategoryInfoPtr category = categoryManager != nullptr
+        ? categoryManager->GetCategoryInfo(categoryId)
+        : CategoryManager::GetNoCategoryInfo();
+
+    store.Append(set.GetAsInt(0), set.GetAsStringView(1), ReadDueDay(set, 2), set.GetAsInt(3),
+                 set.GetAsInt(4) != 0, categoryId, category, userId);
+}
+
+// DatabaseTuning implementation
+const char* DatabaseTuning::DEFAULT_PROFILE = "balanced";
+
+bool DatabaseTuning::FromName(const wxString& name, DatabaseTuning& tuning) {
+    tuning.journalMode = "WAL";
+    tuning.tempStore = "MEMORY";
+    tuning.busyTimeout = 5000;
+
+    if (name.CmpNoCase("durable") == 0) {
+        tuning.name = "durable";
+        tuning.synchronous = "FULL";
+        tuning.cacheSize = -8192;               // 8 MiB
+        tuning.mmapSize = 0;
+        tuning.tempStore = "DEFAULT";
+    } else if (name.CmpNoCase("balanced") == 0) {
+        tuning.name = "balanced";
+        tuning.synchronous = "NORMAL";
+        tuning.cacheSize = -16384;              // 16 MiB
+        tuning.mmapSize = 64LL * 1024 * 1024;
+    } else if (name.CmpNoCase("bulk") == 0) {
+        tuning.name = "bulk";
+        tuning.synchronous = "OFF";
+        tuning.cacheSize = -65536;              // 64 MiB
+        tuning.mmapSize = 256LL * 1024 * 1024;
+        tuning.busyTimeout = 10000;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+DatabaseTuning DatabaseTuning::Load(const wxString& configFile, const wxString& profileOverride) {
+    wxFileConfig config(wxEmptyString, wxEmptyString, configFile, wxEmptyString,
+                        wxCONFIG_USE_LOCAL_FILE | wxCONFIG_USE_RELATIVE_PATH);
+    config.SetPath("/Database");
+
+    wxString profile = profileOverride;
+    if (profile.IsEmpty()) {
+        profile = config.Read("Profile", DEFAULT_PROFILE);
+    }
+
+    DatabaseTuning tuning;
+    if (!FromName(profile, tuning)) {
+        std::cerr << "Unknown database profile '" << profile.ToStdString()
+                  << "', using '" << DEFAULT_PROFILE << "'" << std::endl;
+        FromName(DEFAULT_PROFILE, tuning);
+    }
+
+    // Individual pragmas may be overridden on top of the chosen profile
+    ReadKeyword(config, "JournalMode", JOURNAL_MODES, tuning.journalMode);
+    ReadKeyword(config, "Synchronous", SYNCHRONOUS_MODES, tuning.synchronous);
+    ReadKeyword(config, "TempStore", TEMP_STORES, tuning.tempStore);
+
+    long value;
+    if (config.Read("CacheSize", &value)) {
+        tuning.cacheSize = static_cast<int>(value);
+    }
+    if (config.Read("MmapSize", &value) && value >= 0) {
+        tuning.mmapSize = value;
+    }
+    if (config.Read("BusyTimeout", &value) && value >= 0) {
+        tuning.busyTimeout = static_cast<int>(value);
+    }
+
+    return tuning;
+}
+
+// DatabaseManager implementation
+DatabaseManager::DatabaseManager()
+    : isConnected(false), categoryManager(nullptr), fullTextSearch(false), showErrors(true),
+      flushing(false) {
+    DatabaseTuning::FromName(DatabaseTuning::DEFAULT_PROFILE, tuning);
+}
+
+// Commits the write queue when its window closes
+class WriteFlushTimer : public wxTimer {
+private:
+    DatabaseManager* manager;
+
+public:
+    explicit WriteFlushTimer(DatabaseManager* manager) : manager(manager) {}
+
+    void Notify() override { manager->FlushWrites(); }
+};
+
+DatabaseManager::~DatabaseManager() {
+    // Whoever queued these writes may be gone, along with the windows a
+    // message box would belong to and the category manager that the
+    // changed rows would be read with; commit them without calling back
+    showErrors = false;
+    categoryManager = nullptr;
+    for (QueuedWrite& write : writeQueue) {
+        write.onDone = TaskWriteCallback();
+        write.superseded.clear();
+    }
+    FlushWrites();
+
+    if (isConnected) {
+        db.Close();
+    }
+}
+
+bool DatabaseManager::Connect(const wxString& dbPath) {
+    return Connect(dbPath, tuning);
+}
+
+bool DatabaseManager::Connect(const wxString& dbPath, const DatabaseTuning& connectTuning) {
+    tuning = connectTuning;
+
+    try {
+        std::cout << "Attempting to open database: " << dbPath.ToStdString() << std::endl;
+
+        // Check if the database file exists
+        bool fileExists = wxFileExists(dbPath);
+        std::cout << "Database file exists: " << (fileExists ? "yes" : "no") << std::endl;
+
+        // Open the database using wxSQLite3Database's method
+        db.Open(dbPath);
+        path = dbPath;
+        isConnected = true;
+        std::cout << "Database connected successfully" << std::endl;
+
+        // Enable foreign keys
+        db.ExecuteUpdate("PRAGMA foreign_keys = ON");
+
+        ApplyTuning();
+        LogTuning();
+
+        // Create tables if they don't exist
+        std::cout << "Creating tables if they don't exist" << std::endl;
+        db.ExecuteUpdate(
+            "CREATE TABLE IF NOT EXISTS tasks ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "title TEXT NOT NULL, "
+            "description TEXT, "
+            "due_date TEXT, "
+            "priority INTEGER, "
+            "completed INTEGER DEFAULT 0, "
+            "category_id INTEGER, "
+            "user_id INTEGER, "
+            "FOREIGN KEY(category_id) REFERENCES categories(id), "
+            "FOREIGN KEY(user_id) REFERENCES users(id))"
+        );
+        std::cout << "Tables created successfully" << std::endl;
+
+        MigrateSchema();
+
+        fullTextSearch = TableExists("tasks_fts") && HasModule("fts5");
+        if (!fullTextSearch) {
+            std::cout << "Full-text search unavailable, searching with LIKE" << std::endl;
+        }
+
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+        if (showErrors) {
+            wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
+        }
+        isConnected = false;
+        return false;
+    }
+}
+
+bool DatabaseManager::ConnectReader(const wxString& dbPath, const DatabaseTuning& connectTuning) {
+    tuning = connectTuning;
+
+    try {
+        db.Open(dbPath);
+        path = dbPath;
+        isConnected = true;
+
+        // The journal mode is already the writer's, so this changes nothing
+        // on disk; query_only then refuses any write on this connection
+        ApplyTuning();
+        db.ExecuteUpdate("PRAGMA query_only = ON");
+
+        fullTextSearch = TableExists("tasks_fts") && HasModule("fts5");
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+        isConnected = false;
+        return false;
+    }
+}
+
+void DatabaseManager::ApplyTuning() {
+    // busy_timeout goes first so the journal mode switch can wait for other connections
+    db.ExecuteUpdate(wxString::Format("PRAGMA busy_timeout = %d", tuning.busyTimeout));
+    db.ExecuteUpdate("PRAGMA journal_mode = " + tuning.journalMode);
+    db.ExecuteUpdate("PRAGMA synchronous = " + tuning.synchronous);
+    db.ExecuteUpdate(wxString::Format("PRAGMA cache_size = %d", tuning.cacheSize));
+    db.ExecuteUpdate(wxString::Format("PRAGMA mmap_size = %lld", tuning.mmapSize));
+    db.ExecuteUpdate("PRAGMA temp_store = " + tuning.tempStore);
+}
+
+void DatabaseManager::LogTuning() {
+    // Read the values back: SQLite silently keeps its defaults for settings it
+    // cannot apply (e.g. WAL on an in-memory database, mmap when compiled out)
+    static const char* const pragmas[] = {
+        "journal_mode", "synchronous", "cache_size", "mmap_size", "temp_store", "busy_timeout", nullptr
+    };
+
+    std::cout << "Database tuning profile '" << tuning.name.ToStdString() << "':";
+    for (const char* const* pragma = pragmas; *pragma != nullptr; ++pragma) {
+        wxSQLite3ResultSet set = db.ExecuteQuery(wxString("PRAGMA ") + *pragma);
+        std::cout << " " << *pragma << "=" << (set.NextRow() ? set.GetAsString(0).ToStdString() : "?");
+    }
+    std::cout << std::endl;
+}
+
+int DatabaseManager::GetSchemaVersion() {
+    wxSQLite3ResultSet set = db.ExecuteQuery("PRAGMA user_version");
+    return set.NextRow() ? set.GetAsInt(0) : 0;
+}
+
+int DatabaseManager::GetLatestSchemaVersion() {
+    return MIGRATIONS[sizeof(MIGRATIONS) / sizeof(MIGRATIONS[0]) - 1].version;
+}
+
+void DatabaseManager::MigrateSchema() {
+    int version = GetSchemaVersion();
+    std::cout << "Database schema version " << version
+              << " (latest " << GetLatestSchemaVersion() << ")" << std::endl;
+
+    if (version > GetLatestSchemaVersion()) {
+        std::cerr << "Database was created by a newer version of Task Manager" << std::endl;
+        return;
+    }
+
+    if (version == GetLatestSchemaVersion()) {
+        return;
+    }
+
+    // Table rebuilds copy rows as they are, so foreign keys are not
+    // enforced while migrating. The pragma has no effect inside a
+    // transaction and must be set around the steps.
+    db.ExecuteUpdate("PRAGMA foreign_keys = OFF");
+
+    try {
+        for (const Migration& migration : MIGRATIONS) {
+            if (migration.version <= version) {
+                continue;
+            }
+
+            bool skip = migration.module != nullptr && !HasModule(migration.module);
+            std::cout << "Migrating schema to version " << migration.version
+                      << ": " << migration.description;
+            if (skip) {
+                std::cout << " (skipped, SQLite was built without " << migration.module << ")";
+            }
+            std::cout << std::endl;
+
+            try {
+                db.ExecuteUpdate("BEGIN TRANSACTION");
+                if (!skip) {
+                    db.ExecuteUpdate(migration.sql);
+                }
+                db.ExecuteUpdate(wxString::Format("PRAGMA user_version = %d", migration.version));
+                db.ExecuteUpdate("COMMIT");
+            } catch (wxSQLite3Exception&) {
+                db.ExecuteUpdate("ROLLBACK");
+                throw;
+            }
+
+            version = migration.version;
+        }
+    } catch (wxSQLite3Exception&) {
+        db.ExecuteUpdate("PRAGMA foreign_keys = ON");
+        throw;
+    }
+
+    db.ExecuteUpdate("PRAGMA foreign_keys = ON");
+}
+
+bool DatabaseManager::HasModule(const char* name) {
+    wxSQLite3Statement stmt = db.PrepareStatement("SELECT 1 FROM pragma_module_list WHERE name = ?");
+    stmt.Bind(1, wxString(name));
+    wxSQLite3ResultSet set = stmt.ExecuteQuery();
+    return set.NextRow();
+}
+
+bool DatabaseManager::TableExists(const char* name) {
+    wxSQLite3Statement stmt = db.PrepareStatement("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?");
+    stmt.Bind(1, wxString(name));
+    wxSQLite3ResultSet set = stmt.ExecuteQuery();
+    return set.NextRow();
+}
+
+std::vector<Task> DatabaseManager::GetAllTasks(int userId, bool includeCompleted) {
+    std::vector<Task> results;
+
+    try {
+        TaskFilter filter;
+        filter.includeCompleted = includeCompleted;
+
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            TASK_COLUMNS + TaskListingWhere(filter, nullptr) + TASK_ORDER);
+        BindTaskListing(stmt, userId, nullptr);
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        TaskRowReader reader(categoryManager);
+
+        while (set.NextRow()) {
+            results.emplace_back();
+            reader.Read(set, userId, results.back());
+        }
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        if (showErrors) {
+            wxMessageBox(e.GetMessage(), "Query Error", wxOK | wxICON_ERROR);
+        }
+    }
+
+    return results;
+}
+
+bool DatabaseManager::GetTasksPage(int userId, const TaskFilter& filter, const TaskKey* afterKey,
+                                   int limit, TaskPage& page) {
+    page.tasks.Clear();
+
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            TASK_LIST_COLUMNS + TaskListingWhere(filter, afterKey) + TASK_ORDER + "LIMIT ?");
+        int index = BindTaskListing(stmt, userId, afterKey);
+        stmt.Bind(index, limit);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        TaskRowReader reader(categoryManager);
+        page.tasks.Reserve(limit);
+
+        while (set.NextRow()) {
+            reader.Append(set, userId, page.tasks);
+            ReadTaskKey(set, 2, 3, 0, page.lastKey);
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::GetTaskKeyAt(int userId, const TaskFilter& filter, const TaskKey* afterKey,
+                                   int offset, TaskKey& key) {
+    try {
+        // Only indexed columns are read, so the skipped rows are never loaded
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            "SELECT t.due_day, t.priority, t.id FROM tasks t " +
+            TaskListingWhere(filter, afterKey) + TASK_ORDER + "LIMIT 1 OFFSET ?");
+        int index = BindTaskListing(stmt, userId, afterKey);
+        stmt.Bind(index, offset);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        if (!set.NextRow()) {
+            return false;
+        }
+
+        ReadTaskKey(set, 0, 1, 2, key);
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+int DatabaseManager::CountTasks(int userId, const TaskFilter& filter) {
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            "SELECT COUNT(*) FROM tasks t " + TaskListingWhere(filter, nullptr));
+        BindTaskListing(stmt, userId, nullptr);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        return set.NextRow() ? set.GetAsInt(0) : 0;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return 0;
+    }
+}
+
+bool DatabaseManager::SearchTasks(int userId, const TaskSearch& search, TaskStore& results,
+                                  const TaskBatchCallback& onBatch, size_t batchSize) {
+    results.Clear();
+
+    wxString text = search.text;
+    text.Trim().Trim(false);
+    bool useIndex = fullTextSearch && !text.IsEmpty();
+
+    wxString sql;
+    if (useIndex) {
+        sql = "SELECT t.id, t.title, t.due_day, t.priority, t.completed, t.category_id "
+              "FROM tasks_fts JOIN tasks t ON t.id = tasks_fts.rowid "
+              "WHERE tasks_fts MATCH ? AND t.user_id = ? ";
+    } else {
+        sql = wxString(TASK_LIST_COLUMNS) + "WHERE t.user_id = ? ";
+        if (!text.IsEmpty()) {
+            switch (search.field) {
+                case TaskSearch::TITLE:       sql += "AND t.title LIKE ? "; break;
+                case TaskSearch::DESCRIPTION: sql += "AND t.description LIKE ? "; break;
+                default:                      sql += "AND (t.title LIKE ? OR t.description LIKE ?) "; break;
+            }
+        }
+    }
+
+    if (search.priority > 0) {
+        sql += "AND t.priority = ? ";
+    }
+    if (search.fromDay != NO_DUE_DATE) {
+        sql += "AND t.due_day >= ? ";
+    }
+    if (search.toDay != NO_DUE_DATE) {
+        sql += "AND t.due_day <= ? ";
+    }
+    if (search.categoryId == 0) {
+        sql += "AND t.category_id IS NULL ";
+    } else if (search.categoryId > 0) {
+        sql += "AND t.category_id = ? ";
+    }
+    if (!search.includeCompleted) {
+        sql += "AND t.completed = 0 ";
+    }
+
+    // Title matches weigh ten times as much as description matches
+    sql += useIndex ? "ORDER BY bm25(tasks_fts, 10.0, 1.0), t.due_day, t.priority DESC"
+                    : "ORDER BY t.due_day, t.priority DESC";
+
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(sql);
+        int index = 1;
+
+        if (useIndex) {
+            stmt.Bind(index++, FullTextQuery(text, search.field));
+        }
+        stmt.Bind(index++, userId);
+        if (!useIndex && !text.IsEmpty()) {
+            wxString pattern = "%" + text + "%";
+            stmt.Bind(index++, pattern);
+            if (search.field == TaskSearch::ALL_FIELDS) {
+                stmt.Bind(index++, pattern);
+            }
+        }
+        if (search.priority > 0) {
+            stmt.Bind(index++, search.priority);
+        }
+        if (search.fromDay != NO_DUE_DATE) {
+            stmt.Bind(index++, search.fromDay);
+        }
+        if (search.toDay != NO_DUE_DATE) {
+            stmt.Bind(index++, search.toDay);
+        }
+        if (search.categoryId > 0) {
+            stmt.Bind(index++, search.categoryId);
+        }
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        TaskRowReader reader(categoryManager);
+
+        while (set.NextRow()) {
+            reader.Append(set, userId, results);
+
+            if (onBatch && results.GetCount() >= batchSize) {
+                if (!onBatch(results)) {
+                    return false;
+                }
+                results.Clear();
+            }
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        // An interrupted search has been superseded, not failed
+        if (e.GetErrorCode() != SQLITE_INTERRUPT) {
+            std::cerr << "Search error: " << e.GetMessage().ToStdString() << std::endl;
+        }
+        return false;
+    }
+}
+
+bool DatabaseManager::GetTasksPageWithDescriptions(int userId, const TaskFilter& filter,
+                                                   const TaskKey* afterKey, int limit,
+                                                   std::vector<Task>& tasks) {
+    tasks.clear();
+
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            TASK_COLUMNS + TaskListingWhere(filter, afterKey) + TASK_ORDER + "LIMIT ?");
+        int index = BindTaskListing(stmt, userId, afterKey);
+        stmt.Bind(index, limit);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        TaskRowReader reader(categoryManager);
+        tasks.reserve(limit);
+
+        while (set.NextRow()) {
+            tasks.emplace_back();
+            reader.Read(set, userId, tasks.back());
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::GetTaskDescription(int taskId, wxString& description) {
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement("SELECT description FROM tasks WHERE id = ?");
+        stmt.Bind(1, taskId);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        if (!set.NextRow()) {
+            return false;
+        }
+        description = ToString(set.GetAsStringView(0));
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::GetTaskDescriptions(const std::vector<int>& ids,
+                                          std::unordered_map<int, wxString>& descriptions) {
+    descriptions.clear();
+
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            "SELECT id, description FROM tasks WHERE id IN wx_array(?1)");
+        stmt.Bind(1, ids);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        descriptions.reserve(ids.size());
+        while (set.NextRow()) {
+            descriptions[set.GetAsInt(0)] = ToString(set.GetAsStringView(1));
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+std::vector<Task> DatabaseManager::GetRecentTasks(int userId, int limit) {
+    std::vector<Task> results;
+
+    try {
+        // Follows idx_tasks_user_completed_due, so only limit rows are read
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            wxString(TASK_COLUMNS) +
+            "WHERE t.user_id = ? "
+            "ORDER BY t.completed, t.due_day, t.priority DESC "
+            "LIMIT ?"
+        );
+        stmt.Bind(1, userId);
+        stmt.Bind(2, limit);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        TaskRowReader reader(categoryManager);
+        results.reserve(limit);
+
+        while (set.NextRow()) {
+            results.emplace_back();
+            reader.Read(set, userId, results.back());
+        }
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+    }
+
+    return results;
+}
+
+bool DatabaseManager::GetTaskStatistics(int userId, const wxDateTime& asOfDate, TaskStatistics& stats) {
+    stats.total = stats.completed = stats.pending = stats.urgent = 0;
+
+    int urgentUntil = DueDayFromDateTime(asOfDate) + URGENT_DAYS;
+
+    try {
+        // Totals are kept up to date by triggers on tasks
+        wxSQLite3Statement totals = db.PrepareStatement(
+            "SELECT total, completed FROM task_stats WHERE user_id = ?"
+        );
+        totals.Bind(1, userId);
+
+        wxSQLite3ResultSet set = totals.ExecuteQuery();
+        if (set.NextRow()) {
+            stats.total = set.GetAsInt(0);
+            stats.completed = set.GetAsInt(1);
+            stats.pending = stats.total - stats.completed;
+        }
+        set.Finalize();
+
+        // Urgency depends on the date, so it is counted with a range scan
+        // of idx_tasks_user_completed_due; NULL due days never match
+        wxSQLite3Statement urgent = db.PrepareStatement(
+            "SELECT COUNT(*) FROM tasks "
+            "WHERE user_id = ? AND completed = 0 AND due_day <= ?"
+        );
+        urgent.Bind(1, userId);
+        urgent.Bind(2, urgentUntil);
+
+        set = urgent.ExecuteQuery();
+        if (set.NextRow()) {
+            stats.urgent = set.GetAsInt(0);
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseManager::CheckTaskStats(std::vector<TaskStatsMismatch>& mismatches, bool repair) {
+    mismatches.clear();
+
+    try {
+        wxSQLite3ResultSet set = db.ExecuteQuery(
+            wxString("WITH actual AS (") + ACTUAL_TASK_STATS + ") "
+            "SELECT u.user_id, IFNULL(s.total, 0), IFNULL(s.completed, 0), "
+            "IFNULL(a.total, 0), IFNULL(a.completed, 0) "
+            "FROM (SELECT user_id FROM actual UNION SELECT user_id FROM task_stats) u "
+            "LEFT JOIN task_stats s ON s.user_id = u.user_id "
+            "LEFT JOIN actual a ON a.user_id = u.user_id "
+            "WHERE IFNULL(s.total, 0) <> IFNULL(a.total, 0) "
+            "OR IFNULL(s.completed, 0) <> IFNULL(a.completed, 0)"
+        );
+
+        while (set.NextRow()) {
+            TaskStatsMismatch mismatch;
+            mismatch.userId = set.GetAsInt(0);
+            mismatch.storedTotal = set.GetAsInt(1);
+            mismatch.storedCompleted = set.GetAsInt(2);
+            mismatch.actualTotal = set.GetAsInt(3);
+            mismatch.actualCompleted = set.GetAsInt(4);
+            mismatches.push_back(mismatch);
+
+            std::cerr << "task_stats mismatch for user " << mismatch.userId
+                      << ": stored " << mismatch.storedTotal << "/" << mismatch.storedCompleted
+                      << ", actual " << mismatch.actualTotal << "/" << mismatch.actualCompleted
+                      << std::endl;
+        }
+        set.Finalize();
+
+        if (repair && !mismatches.empty()) {
+            try {
+                db.ExecuteUpdate("BEGIN TRANSACTION");
+                db.ExecuteUpdate("DELETE FROM task_stats");
+                db.ExecuteUpdate(wxString("INSERT INTO task_stats (user_id, total, completed) ") +
+                                 ACTUAL_TASK_STATS);
+                db.ExecuteUpdate("COMMIT");
+            } catch (wxSQLite3Exception&) {
+                db.ExecuteUpdate("ROLLBACK");
+                throw;
+            }
+            std::cout << "Rebuilt task_stats" << std::endl;
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
+        return false;
+    }
+}
+
+void DatabaseManager::ReadChangedTask(const wxSQLite3ResultSet& set, Task& task) {
+    TaskRowReader reader(categoryManager);
+    reader.Read(set, set.GetAsInt(7), task);
+}
+
+bool DatabaseManager::AddTask(const wxString& title, const wxString& description,
+                              int dueDay, int priority, int categoryId, int userId,
+                              TaskChange* change) {
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            wxString("INSERT INTO tasks (title, description, due_day, priority, category_id, user_id) "
+                     "VALUES (?, ?, ?, ?, ?, ?) RETURNING ") + CHANGED_TASK_COLUMNS
+        );
+
+        stmt.Bind(1, title);
+        stmt.Bind(2, description);
+        BindDueDay(stmt, 3, dueDay);
+        stmt.Bind(4, priority);
+
+        if (categoryId > 0) {
+            stmt.Bind(5, categoryId);
+        } else {
+            stmt.BindNull(5);
+        }
+
+        stmt.Bind(6, userId);
+
+        // Stepping the statement runs the insert
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        if (set.NextRow() && change != nullptr) {
+            ReadChangedTask(set, change->after);
+            change->hasAfter = true;
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        ReportWriteError(e);
+        return false;
+    }
+}
+
+bool DatabaseManager::UpdateTask(int id, const wxString& title, const wxString& description,
+                                 int dueDay, int priority, bool completed, int categoryId,
+                                 TaskChange* change) {
+    try {
+        // The old row is only needed to tell views where the task was
+        if (change != nullptr) {
+            wxSQLite3Statement select = db.PrepareStatement(
+                wxString("SELECT ") + CHANGED_TASK_COLUMNS + "FROM tasks WHERE id = ?");
+            select.Bind(1, id);
+            wxSQLite3ResultSet set = select.ExecuteQuery();
+            if (!set.NextRow()) {
+                return false;
+            }
+            ReadChangedTask(set, change->before);
+            change->hasBefore = true;
+        }
+
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            wxString("UPDATE tasks SET title = ?, description = ?, due_day = ?, "
+                     "priority = ?, completed = ?, category_id = ? WHERE id = ? RETURNING ") +
+            CHANGED_TASK_COLUMNS
+        );
+
+        stmt.Bind(1, title);
+        stmt.Bind(2, description);
+        BindDueDay(stmt, 3, dueDay);
+        stmt.Bind(4, priority);
+        stmt.Bind(5, completed ? 1 : 0);
+
+        if (categoryId > 0) {
+            stmt.Bind(6, categoryId);
+        } else {
+            stmt.BindNull(6);
+        }
+
+        stmt.Bind(7, id);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        if (!set.NextRow()) {
+            return false;
+        }
+        if (change != nullptr) {
+            ReadChangedTask(set, change->after);
+            change->hasAfter = true;
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        ReportWriteError(e);
+        return false;
+    }
+}
+
+bool DatabaseManager::DeleteTask(int id, TaskChange* change) {
+    try {
+        wxSQLite3Statement stmt = db.PrepareStatement(
+            wxString("DELETE FROM tasks WHERE id = ? RETURNING ") + CHANGED_TASK_COLUMNS);
+        stmt.Bind(1, id);
+
+        wxSQLite3ResultSet set = stmt.ExecuteQuery();
+        if (!set.NextRow()) {
+            return false;
+        }
+        if (change != nullptr) {
+            ReadChangedTask(set, change->before);
+            change->hasBefore = true;
+        }
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        ReportWriteError(e);
+        return false;
+    }
+}
+
+bool DatabaseManager::EditTasks(const std::vector<int>& ids, const TaskBatchEdit& edit,
+                                std::vector<TaskChange>& changes) {
+    changes.clear();
+    if (ids.empty()) {
+        return true;
+    }
+
+    // A queued update committed afterwards would undo the edit
+    FlushWrites();
+
+    // Changes are looked up by task id as rows come back
+    std::unordered_map<int, size_t> changeIndex;
+    try {
+        db.ExecuteUpdate("BEGIN IMMEDIATE");
+
+        // The ids are bound as one array, so every statement below is
+        // prepared once whatever the number of tasks
+        wxString where = "WHERE id IN wx_array(?1)";
+        if (edit.action == TaskBatchEdit::COMPLETE) {
+            where += " AND completed = 0";
+        }
+
+        if (edit.action == TaskBatchEdit::REMOVE) {
+            wxSQLite3Statement stmt = db.PrepareStatement(
+                "DELETE FROM tasks " + where + " RETURNING " + CHANGED_TASK_COLUMNS);
+            stmt.Bind(1, ids);
+            wxSQLite3ResultSet set = stmt.ExecuteQuery();
+            while (set.NextRow()) {
+                changes.emplace_back();
+                ReadChangedTask(set, changes.back().before);
+                changes.back().hasBefore = true;
+            }
+        } else {
+            wxSQLite3Statement select = db.PrepareStatement(
+                wxString("SELECT ") + CHANGED_TASK_COLUMNS + "FROM tasks " + where);
+            select.Bind(1, ids);
+            wxSQLite3ResultSet before = select.ExecuteQuery();
+            while (before.NextRow()) {
+                changes.emplace_back();
+                ReadChangedTask(before, changes.back().before);
+                changes.back().hasBefore = true;
+                changeIndex[changes.back().before.id] = changes.size() - 1;
+            }
+            before.Finalize();
+
+            wxString set;
+            switch (edit.action) {
+                case TaskBatchEdit::COMPLETE:
+                    set = "completed = 1";
+                    break;
+                case TaskBatchEdit::SET_PRIORITY:
+                    set = "priority = ?2";
+                    break;
+                default:
+                    set = "category_id = ?2";
+                    break;
+            }
+            wxSQLite3Statement stmt = db.PrepareStatement(
+                "UPDATE tasks SET " + set + " " + where + " RETURNING " + CHANGED_TASK_COLUMNS);
+            stmt.Bind(1, ids);
+            if (edit.action == TaskBatchEdit::SET_PRIORITY) {
+                stmt.Bind(2, edit.value);
+            } else if (edit.action == TaskBatchEdit::SET_CATEGORY) {
+                if (edit.value > 0) {
+                    stmt.Bind(2, edit.value);
+                } else {
+                    stmt.BindNull(2);
+                }
+            }
+
+            wxSQLite3ResultSet after = stmt.ExecuteQuery();
+            while (after.NextRow()) {
+                auto found = changeIndex.find(after.GetAsInt(0));
+                if (found != changeIndex.end()) {
+                    TaskChange& change = changes[found->second];
+                    ReadChangedTask(after, change.after);
+                    change.hasAfter = true;
+                }
+            }
+        }
+
+        db.ExecuteUpdate("COMMIT");
+
+        // In listing order, so that views see runs of adjacent rows
+        std::sort(changes.begin(), changes.end(), [](const TaskChange& a, const TaskChange& b) {
+            return TaskKey::Of(a.before) < TaskKey::Of(b.before);
+        });
+        std::cout << "Edited " << changes.size() << " of " << ids.size() << " selected tasks" << std::endl;
+        return true;
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+        if (!db.GetAutoCommit()) {
+            try {
+                db.ExecuteUpdate("ROLLBACK");
+            } catch (wxSQLite3Exception& rollbackError) {
+                std::cerr << "Rollback failed: " << rollbackError.GetMessage().ToStdString() << std::endl;
+            }
+        }
+        if (showErrors) {
+            wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
+        }
+        changes.clear();
+        return false;
+    }
+}
+
+void DatabaseManager::ReportWriteError(const wxSQLite3Exception& e) {
+    std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+    if (flushing) {
+        flushErrors.push_back(e.GetMessage());
+    } else if (showErrors) {
+        wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
+    }
+}
+
+void DatabaseManager::QueueAddTask(const wxString& title, const wxString& description,
+                                   int dueDay, int priority, int categoryId, int userId,
+                                   const TaskWriteCallback& onDone) {
+    QueuedWrite write;
+    write.kind = QueuedWrite::ADD_TASK;
+    write.id = 0;
+    write.title = title;
+    write.description = description;
+    write.dueDay = dueDay;
+    write.priority = priority;
+    write.completed = false;
+    write.categoryId = categoryId;
+    write.userId = userId;
+    write.onDone = onDone;
+    QueueWrite(std::move(write));
+}
+
+void DatabaseManager::QueueUpdateTask(int id, const wxString& title, const wxString& description,
+                                      int dueDay, int priority, bool completed, int categoryId,
+                                      const TaskWriteCallback& onDone) {
+    QueuedWrite write;
+    write.kind = QueuedWrite::UPDATE_TASK;
+    write.id = id;
+    write.title = title;
+    write.description = description;
+    write.dueDay = dueDay;
+    write.priority = priority;
+    write.completed = completed;
+    write.categoryId = categoryId;
+    write.userId = 0;
+    write.onDone = onDone;
+    QueueWrite(std::move(write));
+}
+
+void DatabaseManager::QueueDeleteTask(int id, const TaskWriteCallback& onDone) {
+    QueuedWrite write;
+    write.kind = QueuedWrite::DELETE_TASK;
+    write.id = id;
+    write.dueDay = NO_DUE_DATE;
+    write.priority = 0;
+    write.completed = false;
+    write.categoryId = -1;
+    write.userId = 0;
+    write.onDone = onDone;
+    QueueWrite(std::move(write));
+}
+
+void DatabaseManager::QueueWrite(QueuedWrite write) {
+    // An update replaces the task's queued update, as long as nothing else
+    // for the task is queued after it; it sets every column, so only the
+    // last one matters
+    if (write.kind == QueuedWrite::UPDATE_TASK) {
+        for (auto it = writeQueue.rbegin(); it != writeQueue.rend(); ++it) {
+            if (it->kind == QueuedWrite::ADD_TASK || it->id != write.id) {
+                continue;
+            }
+            if (it->kind == QueuedWrite::UPDATE_TASK) {
+                write.superseded.swap(it->superseded);
+                if (it->onDone) {
+                    write.superseded.push_back(it->onDone);
+                }
+                *it = std::move(write);
+                return;
+            }
+            break;
+        }
+    }
+
+    writeQueue.push_back(std::move(write));
+
+    if (writeQueue.size() >= WRITE_BATCH_LIMIT) {
+        FlushWrites();
+        return;
+    }
+    if (!writeTimer) {
+        writeTimer.reset(new WriteFlushTimer(this));
+    }
+    if (!writeTimer->IsRunning()) {
+        writeTimer->StartOnce(WRITE_DELAY_MS);
+    }
+}
+
+bool DatabaseManager::RunWrite(const QueuedWrite& write, TaskChange& change) {
+    switch (write.kind) {
+        case QueuedWrite::ADD_TASK:
+            return AddTask(write.title, write.description, write.dueDay, write.priority,
+                           write.categoryId, write.userId, &change);
+        case QueuedWrite::UPDATE_TASK:
+            return UpdateTask(write.id, write.title, write.description, write.dueDay, write.priority,
+                              write.completed, write.categoryId, &change);
+        case QueuedWrite::DELETE_TASK:
+            return DeleteTask(write.id, &change);
+    }
+    return false;
+}
+
+bool DatabaseManager::FlushWrites() {
+    if (writeTimer) {
+        writeTimer->Stop();
+    }
+    if (writeQueue.empty()) {
+        return true;
+    }
+
+    // Completions may queue more writes, which go in the next transaction
+    std::vector<QueuedWrite> writes;
+    writes.swap(writeQueue);
+    std::vector<TaskChange> changes(writes.size());
+    std::vector<bool> succeeded(writes.size(), false);
+
+    // Each write runs in its own savepoint, so a failing one is undone
+    // alone and the others still commit. Some errors, such as a full disk
+    // or an interrupt, make SQLite roll back the whole transaction; the
+    // writes before the failing one are gone then too, and the rest are
+    // not attempted. Message boxes wait until the transaction has ended,
+    // as their event loop may run the write timer.
+    bool committed = true;
+    flushing = true;
+    try {
+        db.ExecuteUpdate("BEGIN IMMEDIATE");
+        for (size_t i = 0; i < writes.size(); ++i) {
+            db.ExecuteUpdate("SAVEPOINT queued_write");
+            succeeded[i] = RunWrite(writes[i], changes[i]);
+            if (db.GetAutoCommit()) {
+                committed = false;
+                break;
+            }
+            if (!succeeded[i]) {
+                db.ExecuteUpdate("ROLLBACK TO queued_write");
+            }
+            db.ExecuteUpdate("RELEASE queued_write");
+        }
+        if (committed) {
+            db.ExecuteUpdate("COMMIT");
+        }
+    } catch (wxSQLite3Exception& e) {
+        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
+        if (!db.GetAutoCommit()) {
+            try {
+                db.ExecuteUpdate("ROLLBACK");
+            } catch (wxSQLite3Exception& rollbackError) {
+                std::cerr << "Rollback failed: " << rollbackError.GetMessage().ToStdString() << std::endl;
+            }
+        }
+        flushErrors.push_back(e.GetMessage());
+        committed = false;
+    }
+    flushing = false;
+
+    std::vector<wxString> errors;
+    errors.swap(flushErrors);
+
+    for (size_t i = 0; i < writes.size(); ++i) {
+        bool ok = committed && succeeded[i];
+        for (const TaskWriteCallback& onDone : writes[i].superseded) {
+            onDone(ok, TaskChange());
+        }
+        if (writes[i].onDone) {
+            if (ok) {
+                writes[i].onDone(true, changes[i]);
+            } else {
+                writes[i].onDone(false, TaskChange());
+            }
+        }
+    }
+
+    if (showErrors && !errors.empty()) {
+        wxString message;
+        for (const wxString& error : errors) {
+            if (!message.IsEmpty()) {
+                message += "\n";
+            }
+            message += error;
+        }
+        wxMessageBox(message, "Database Error", wxOK | wxICON_ERROR);
+    }
+    return committed;
+}
@@ -0,0 +1,317 @@
+#ifndef DATABASE_MANAGER_H
+#define DATABASE_MANAGER_H
+
+#include <wx/wx.h>
+#include "wxsqlite3/wxsqlite3.h"
+#include "category_manager.h"
+#include "due_date.h"
+#include "task_store.h"
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+// Enhanced Task data structure
+struct Task {
+    int id;
+    wxString title;
+    wxString description;
+    int dueDay;     // See due_date.h; NO_DUE_DATE when not set
+    int priority;
+    bool completed;
+    int categoryId;
+    CategoryInfoPtr category;   // Interned by CategoryManager, never null
+    int userId; // Owner of the task
+};
+
+// Which tasks a listing includes
+struct TaskFilter {
+    bool includeCompleted;
+
+    TaskFilter() : includeCompleted(true) {}
+};
+
+// Position of a task in the listing order: due_day (NULLs first),
+// priority DESC, id. Pages continue after the key of the previous page's
+// last row, so a page costs the same wherever it is in the list.
+struct TaskKey {
+    int dueDay;     // NO_DUE_DATE for NULL
+    int priority;
+    int id;
+
+    static TaskKey Of(const Task& task) { return TaskKey{task.dueDay, task.priority, task.id}; }
+
+    // Listing order, the same as the SQL ORDER BY
+    bool operator<(const TaskKey& other) const {
+        if (dueDay != other.dueDay) return dueDay < other.dueDay;
+        if (priority != other.priority) return priority > other.priority;
+        return id < other.id;
+    }
+    bool operator==(const TaskKey& other) const {
+        return dueDay == other.dueDay && priority == other.priority && id == other.id;
+    }
+};
+
+// One page of a task listing
+struct TaskPage {
+    TaskStore tasks;
+    TaskKey lastKey;    // Valid when tasks is not empty
+};
+
+// A task row as it was before and after AddTask, UpdateTask or
+// DeleteTask, read back in the same statement so that views can apply
+// the edit without reloading. An added task has only after, a deleted
+// one only before.
+struct TaskChange {
+    bool hasBefore;
+    bool hasAfter;
+    Task before;
+    Task after;
+
+    // The missing side is zeroed, so that changes can be copied
+    TaskChange() : hasBefore(false), hasAfter(false), before(), after() {}
+};
+
+// A change made to many tasks at once by DatabaseManager::EditTasks
+struct TaskBatchEdit {
+    enum Action { COMPLETE, REMOVE, SET_PRIORITY, SET_CATEGORY };
+
+    Action action;
+    int value;      // SET_PRIORITY: the priority; SET_CATEGORY: the category id, -1 for none
+};
+
+// Completion of a queued task write, called on the UI thread after the
+// write's transaction. change is filled as by AddTask, UpdateTask and
+// DeleteTask; it is empty when the write failed or was folded into a
+// later update of the same task.
+typedef std::function<void(bool ok, const TaskChange& change)> TaskWriteCallback;
+
+// Criteria of a task search
+struct TaskSearch {
+    enum Field { TITLE, DESCRIPTION, ALL_FIELDS };
+
+    wxString text;      // Words to find; empty matches every task
+    Field field;
+    int priority;       // 0 for any priority
+    int fromDay;        // Due day range, inclusive; NO_DUE_DATE leaves
+    int toDay;          // that end open
+    int categoryId;     // -1 for any category, 0 for tasks without one
+    bool includeCompleted;
+};
+
+// Dashboard counters for one user
+struct TaskStatistics {
+    int total;
+    int completed;
+    int pending;
+    int urgent;     // Pending and due within URGENT_DAYS, or overdue
+};
+
+// A user whose task_stats row disagrees with the tasks table
+struct TaskStatsMismatch {
+    int userId;
+    int storedTotal;
+    int storedCompleted;
+    int actualTotal;
+    int actualCompleted;
+};
+
+// Decodes rows of the task SELECTs. Read takes the full layout used by
+// GetAllTasks: id, title, description, due_day, priority, completed,
+// category_id. Append takes the listing layout used by GetTasksPage and
+// SearchDialog, which leaves out the description: id, title, due_day,
+// priority, completed, category_id.
+// Text is read through zero-copy views and converted once; the category
+// is resolved to the record interned by CategoryManager, so the query
+// needs no join and tasks of one category share a single copy of it.
+class TaskRowReader {
+private:
+    CategoryManager* categoryManager;
+
+public:
+    // Without a category manager every task reads as "No Category"
+    explicit TaskRowReader(CategoryManager* categoryManager) : categoryManager(categoryManager) {}
+
+    void Read(const wxSQLite3ResultSet& set, int userId, Task& task);
+    void Append(const wxSQLite3ResultSet& set, int userId, TaskStore& store);
+};
+
+// Connection tuning profile applied when the database is opened.
+// Built-in profiles:
+//   durable  - WAL, synchronous=FULL; every commit survives power loss
+//   balanced - WAL, synchronous=NORMAL; the default
+//   bulk     - WAL, synchronous=OFF and large caches for imports; a crash
+//              may lose the last transactions but never corrupts the file
+struct DatabaseTuning {
+    wxString name;
+    wxString journalMode;   // PRAGMA journal_mode
+    wxString synchronous;   // PRAGMA synchronous
+    int cacheSize;          // PRAGMA cache_size (negative values are KiB)
+    long long mmapSize;     // PRAGMA mmap_size in bytes, 0 disables mmap
+    wxString tempStore;     // PRAGMA temp_store
+    int busyTimeout;        // Milliseconds to wait on a locked database
+
+    static const char* DEFAULT_PROFILE;
+
+    // Fills in a built-in profile; returns false for an unknown name
+    static bool FromName(const wxString& name, DatabaseTuning& tuning);
+
+    // Reads the [Database] group of configFile (Profile plus optional
+    // per-pragma overrides). A non-empty profileOverride, e.g. from the
+    // command line, takes precedence over the configured profile name.
+    static DatabaseTuning Load(const wxString& configFile, const wxString& profileOverride);
+};
+
+class WriteFlushTimer;
+
+// Enhanced Database Manager class
+class DatabaseManager {
+private:
+    // A task write waiting in the write queue
+    struct QueuedWrite {
+        enum Kind { ADD_TASK, UPDATE_TASK, DELETE_TASK };
+
+        Kind kind;
+        int id;             // Task id; unused for ADD_TASK
+        wxString title;
+        wxString description;
+        int dueDay;
+        int priority;
+        bool completed;
+        int categoryId;
+        int userId;         // ADD_TASK only
+        TaskWriteCallback onDone;
+        // Completions of earlier updates this one replaced
+        std::vector<TaskWriteCallback> superseded;
+    };
+
+    wxSQLite3Database db;
+    wxString path;
+    bool isConnected;
+    DatabaseTuning tuning;
+    CategoryManager* categoryManager;
+    bool fullTextSearch;    // tasks_fts exists and FTS5 is available
+    bool showErrors;        // Errors also go to a message box
+    bool flushing;          // FlushWrites has a transaction open
+    std::vector<wxString> flushErrors;  // Shown once FlushWrites is done
+    std::vector<QueuedWrite> writeQueue;
+    std::unique_ptr<WriteFlushTimer> writeTimer;
+
+    void ApplyTuning();
+    void LogTuning();
+    void MigrateSchema();
+    bool HasModule(const char* name);
+    bool TableExists(const char* name);
+    // Reads a row returned by AddTask, UpdateTask and DeleteTask
+    void ReadChangedTask(const wxSQLite3ResultSet& set, Task& task);
+    // Reports an error of AddTask, UpdateTask or DeleteTask, or keeps it
+    // for later while FlushWrites runs
+    void ReportWriteError(const wxSQLite3Exception& e);
+    void QueueWrite(QueuedWrite write);
+    bool RunWrite(const QueuedWrite& write, TaskChange& change);
+
+public:
+    DatabaseManager();
+    ~DatabaseManager();
+
+    bool Connect(const wxString& dbPath);
+    bool Connect(const wxString& dbPath, const DatabaseTuning& tuning);
+    // Opens a read-only connection to a database that a connection opened
+    // with Connect has already created and migrated; see ConnectionPool
+    bool ConnectReader(const wxString& dbPath, const DatabaseTuning& tuning);
+    bool IsConnected() const { return isConnected; }
+    wxSQLite3Database* GetDatabase() { return &db; }
+    const wxString& GetPath() const { return path; }
+    const DatabaseTuning& GetTuning() const { return tuning; }
+    // Resolves the categories of loaded tasks; set once it exists
+    void SetCategoryManager(CategoryManager* manager) { categoryManager = manager; }
+    // Connections used off the UI thread report errors on the console only
+    void SetShowErrors(bool show) { showErrors = show; }
+
+    // Schema version recorded in PRAGMA user_version
+    int GetSchemaVersion();
+    static int GetLatestSchemaVersion();
+
+    // Task management
+    std::vector<Task> GetAllTasks(int userId, bool includeCompleted = true);
+    // Up to limit tasks following afterKey (nullptr for the first page)
+    bool GetTasksPage(int userId, const TaskFilter& filter, const TaskKey* afterKey,
+                      int limit, TaskPage& page);
+    // Key of the task offset rows after afterKey, read from the index
+    // alone; used to find where a page starts without loading the rows
+    // before it. Returns false past the end of the listing.
+    bool GetTaskKeyAt(int userId, const TaskFilter& filter, const TaskKey* afterKey,
+                      int offset, TaskKey& key);
+    int CountTasks(int userId, const TaskFilter& filter);
+    // GetTasksPage with descriptions, as whole Tasks, for the CSV export;
+    // the next page follows TaskKey::Of(tasks.back())
+    bool GetTasksPageWithDescriptions(int userId, const TaskFilter& filter, const TaskKey* afterKey,
+                                      int limit, std::vector<Task>& tasks);
+    // Listings leave descriptions out; this loads one when a task is opened
+    bool GetTaskDescription(int taskId, wxString& description);
+    // Descriptions of the tasks in ids, keyed by id, read in one query
+    bool GetTaskDescriptions(const std::vector<int>& ids, std::unordered_map<int, wxString>& descriptions);
+    // Tasks matching search, best matches first when there is search text
+    // and by due date otherwise. Words match by prefix through the FTS5
+    // index; without FTS5 they fall back to substring LIKE scans.
+    // With onBatch, each batchSize rows read are handed to it and then
+    // cleared from results, leaving only the last partial batch there;
+    // returning false from onBatch stops the search. Returns false when
+    // the search fails, is stopped or is interrupted.
+    typedef std::function<bool(TaskStore& batch)> TaskBatchCallback;
+    bool SearchTasks(int userId, const TaskSearch& search, TaskStore& results,
+                     const TaskBatchCallback& onBatch = TaskBatchCallback(), size_t batchSize = 0);
+    bool HasFullTextSearch() const { return fullTextSearch; }
+    // The first limit tasks with pending ones first, each group by due date
+    std::vector<Task> GetRecentTasks(int userId, int limit);
+
+    // Task counts as of a date. Totals come from the trigger-maintained
+    // task_stats table; urgent tasks are counted with an index range scan.
+    static const int URGENT_DAYS = 7;
+    bool GetTaskStatistics(int userId, const wxDateTime& asOfDate, TaskStatistics& stats);
+    // Recomputes every user's counts from tasks and reports the users
+    // whose task_stats row differs; with repair, rebuilds task_stats
+    bool CheckTaskStats(std::vector<TaskStatsMismatch>& mismatches, bool repair = false);
+    // The mutations fill change, when given, with the affected row.
+    // UpdateTask and DeleteTask return false when the task does not exist.
+    bool AddTask(const wxString& title, const wxString& description,
+                 int dueDay, int priority, int categoryId, int userId,
+                 TaskChange* change = nullptr);
+    bool UpdateTask(int id, const wxString& title, const wxString& description,
+                    int dueDay, int priority, bool completed, int categoryId,
+                    TaskChange* change = nullptr);
+    bool DeleteTask(int id, TaskChange* change = nullptr);
+    // Applies edit to the tasks in ids with one statement and in one
+    // transaction, after committing queued writes. changes receives a
+    // TaskChange for each task edited, in listing order of the old rows;
+    // COMPLETE skips tasks already completed. Returns false, with nothing
+    // changed, on error.
+    bool EditTasks(const std::vector<int>& ids, const TaskBatchEdit& edit,
+                   std::vector<TaskChange>& changes);
+
+    // Write-behind queue for edits made in quick succession, used on the
+    // UI thread. Queued writes are committed together in one transaction
+    // WRITE_DELAY_MS after the first of them, or at once when
+    // WRITE_BATCH_LIMIT are waiting. Updating a task whose previous
+    // update is still queued replaces that update. Each write's
+    // completion runs after the commit; the destructor commits whatever
+    // is left without calling completions. Code writing directly, such
+    // as the importer, flushes the queue first.
+    static const int WRITE_DELAY_MS = 50;
+    static const size_t WRITE_BATCH_LIMIT = 256;
+    void QueueAddTask(const wxString& title, const wxString& description,
+                      int dueDay, int priority, int categoryId, int userId,
+                      const TaskWriteCallback& onDone = TaskWriteCallback());
+    void QueueUpdateTask(int id, const wxString& title, const wxString& description,
+                         int dueDay, int priority, bool completed, int categoryId,
+                         const TaskWriteCallback& onDone = TaskWriteCallback());
+    void QueueDeleteTask(int id, const TaskWriteCallback& onDone = TaskWriteCallback());
+    // Commits the queued writes now and runs their completions, then
+    // shows one message for all of their errors; returns false when the
+    // transaction failed, in which case none was applied
+    bool FlushWrites();
+    bool HasQueuedWrites() const { return !writeQueue.empty(); }
+};
+
+#endif // DATABASE_MANAGER_H
@@ -0,0 +1,185 @@
+#include "db_worker.h"
+#include <iostream>
+
+namespace {
+
+// Virtual machine steps between checks for a cancelled request
+const int PROGRESS_INSTRUCTIONS = 1000;
+
+} // namespace
+
+// DbRequest implementation
+void DbRequest::Cancel() {
+    if (state) {
+        state->cancelled = true;
+    }
+}
+
+bool DbRequest::IsCancelled() const {
+    return state && state->cancelled;
+}
+
+bool DbRequest::IsPending() const {
+    return state && !state->cancelled && !state->finished;
+}
+
+// DbWorker implementation
+DbWorker::DbWorker(wxEvtHandler* owner, ConnectionPool* pool)
+    : owner(owner), pool(pool), stopping(false) {
+}
+
+DbWorker::~DbWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    CancelAll();
+    wakeUp.notify_one();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool DbWorker::Start() {
+    if (pool->GetReaderCount() == 0) {
+        std::cerr << "Database worker unavailable, running requests on the UI thread" << std::endl;
+        return false;
+    }
+
+    worker = std::thread(&DbWorker::Run, this);
+    return true;
+}
+
+void DbWorker::CancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Item& item : queue) {
+        item.state->cancelled = true;
+    }
+    queue.clear();
+
+    // The progress handler interrupts its statement
+    if (current) {
+        current->cancelled = true;
+    }
+}
+
+DbRequest DbWorker::Enqueue(Job job) {
+    DbRequest request;
+    request.state = std::make_shared<DbRequest::State>();
+
+    if (!worker.joinable()) {
+        job(*pool->GetWriter(), request.state);
+        return request;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(Item{request.state, std::move(job)});
+    }
+    wakeUp.notify_one();
+    return request;
+}
+
+void DbWorker::Run() {
+    for (;;) {
+        Item item;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            current.reset();
+            wakeUp.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+
+            item = std::move(queue.front());
+            queue.pop_front();
+            if (item.state->cancelled) {
+                continue;
+            }
+            current = item.state;
+        }
+
+        // The reader is shared with other threads, so the handler that
+        // watches for cancellation is only installed while the job runs
+        ConnectionPool::Reader reader = pool->AcquireReader();
+        wxSQLite3Database* db = reader->GetDatabase();
+        db->SetProgressHandler(PROGRESS_INSTRUCTIONS, &DbWorker::OnProgress, this);
+        item.job(*reader, item.state);
+        db->SetProgressHandler(0, nullptr, nullptr);
+    }
+}
+
+void DbWorker::Complete(const StatePtr& state, std::function<void()> completion) {
+    if (state->cancelled) {
+        return;
+    }
+
+    // Checked again on the UI thread, where Cancel is usually called
+    owner->CallAfter([state, completion] {
+        state->finished = true;
+        if (!state->cancelled) {
+            completion();
+        }
+    });
+}
+
+int DbWorker::OnProgress(void* worker) {
+    // Runs on the worker thread, the only one that assigns current
+    const StatePtr& running = static_cast<DbWorker*>(worker)->current;
+    return running && running->cancelled ? 1 : 0;
+}
+
+DbRequest DbWorker::GetAllTasks(int userId, bool includeCompleted,
+                                const std::function<void(std::vector<Task>& tasks)>& onDone) {
+    return Post([userId, includeCompleted](DatabaseManager& db) {
+        return db.GetAllTasks(userId, includeCompleted);
+    }, onDone);
+}
+
+DbRequest DbWorker::CountTasks(int userId, const TaskFilter& filter,
+                               const std::function<void(int count)>& onDone) {
+    return Post([userId, filter](DatabaseManager& db) {
+        return db.CountTasks(userId, filter);
+    }, onDone);
+}
+
+DbRequest DbWorker::GetTaskDescription(int taskId,
+                                       const std::function<void(bool found, wxString& description)>& onDone) {
+    return Post([taskId](DatabaseManager& db) {
+        std::pair<bool, wxString> result;
+        result.first = db.GetTaskDescription(taskId, result.second);
+        return result;
+    }, [onDone](std::pair<bool, wxString>& result) {
+        onDone(result.first, result.second);
+    });
+}
+
+DbRequest DbWorker::SearchTasks(int userId, const TaskSearch& search,
+                                const std::function<void(bool completed, TaskStore& results)>& onDone) {
+    return Post([userId, search](DatabaseManager& db) {
+        std::pair<bool, TaskStore> result;
+        result.first = db.SearchTasks(userId, search, result.second);
+        return result;
+    }, [onDone](std::pair<bool, TaskStore>& result) {
+        onDone(result.first, result.second);
+    });
+}
+
+DbRequest DbWorker::GetRecentTasks(int userId, int limit,
+                                   const std::function<void(std::vector<Task>& tasks)>& onDone) {
+    return Post([userId, limit](DatabaseManager& db) {
+        return db.GetRecentTasks(userId, limit);
+    }, onDone);
+}
+
+DbRequest DbWorker::GetTaskStatistics(int userId, const wxDateTime& asOfDate,
+                                      const std::function<void(bool ok, TaskStatistics& stats)>& onDone) {
+    return Post([userId, asOfDate](DatabaseManager& db) {
+        std::pair<bool, TaskStatistics> result;
+        result.first = db.GetTaskStatistics(userId, asOfDate, result.second);
+        return result;
+    }, [onDone](std::pair<bool, TaskStatistics>& result) {
+        onDone(result.first, result.second);
+    });
+}
@@ -0,0 +1,115 @@
+#ifndef DB_WORKER_H
+#define DB_WORKER_H
+
+#include <wx/wx.h>
+#include "connection_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Handle to a request posted to a DbWorker; copies refer to the same
+// request. A cancelled request is skipped if it has not started, its
+// running statement is interrupted, and its completion is never called.
+class DbRequest {
+public:
+    DbRequest() {}
+
+    // Safe to call at any time, on an empty handle too
+    void Cancel();
+    bool IsCancelled() const;
+    // Queued or running, with its completion still to come
+    bool IsPending() const;
+
+private:
+    friend class DbWorker;
+
+    struct State {
+        std::atomic<bool> cancelled;
+        std::atomic<bool> finished;
+
+        State() : cancelled(false), finished(false) {}
+    };
+
+    std::shared_ptr<State> state;
+};
+
+// Runs read-only database requests in order on a worker thread, so that
+// event handlers never wait for SQLite. Each request borrows a reader
+// from the pool and sees one snapshot of the database. Completions run on
+// the UI thread through owner->CallAfter.
+class DbWorker {
+public:
+    DbWorker(wxEvtHandler* owner, ConnectionPool* pool);
+    // Cancels every request and waits for the running one to stop
+    ~DbWorker();
+
+    // Starts the thread. Without readers in the pool requests run on the
+    // writer when posted, and their completions are still delivered
+    // later on the UI thread.
+    bool Start();
+
+    // Runs work(reader) on the worker and then onDone(result) on the UI
+    // thread. work must not write; it returns the result by value, not
+    // void.
+    template <typename Work, typename Done>
+    DbRequest Post(Work work, Done onDone);
+
+    void CancelAll();
+
+    // Counterparts of the DatabaseManager queries
+    DbRequest GetAllTasks(int userId, bool includeCompleted,
+                          const std::function<void(std::vector<Task>& tasks)>& onDone);
+    DbRequest CountTasks(int userId, const TaskFilter& filter,
+                         const std::function<void(int count)>& onDone);
+    DbRequest GetTaskDescription(int taskId,
+                                 const std::function<void(bool found, wxString& description)>& onDone);
+    DbRequest SearchTasks(int userId, const TaskSearch& search,
+                          const std::function<void(bool completed, TaskStore& results)>& onDone);
+    DbRequest GetRecentTasks(int userId, int limit,
+                             const std::function<void(std::vector<Task>& tasks)>& onDone);
+    DbRequest GetTaskStatistics(int userId, const wxDateTime& asOfDate,
+                                const std::function<void(bool ok, TaskStatistics& stats)>& onDone);
+
+private:
+    typedef std::shared_ptr<DbRequest::State> StatePtr;
+    typedef std::function<void(DatabaseManager& connection, const StatePtr& state)> Job;
+
+    struct Item {
+        StatePtr state;
+        Job job;
+    };
+
+    wxEvtHandler* owner;
+    ConnectionPool* pool;
+    std::thread worker;
+
+    std::mutex mutex;           // Guards the members below
+    std::condition_variable wakeUp;
+    std::deque<Item> queue;
+    StatePtr current;           // Request the worker is running
+    bool stopping;
+
+    DbRequest Enqueue(Job job);
+    void Run();
+    void Complete(const StatePtr& state, std::function<void()> completion);
+    static int OnProgress(void* worker);
+};
+
+template <typename Work, typename Done>
+DbRequest DbWorker::Post(Work work, Done onDone) {
+    typedef decltype(work(std::declval<DatabaseManager&>())) Result;
+
+    return Enqueue([this, work, onDone](DatabaseManager& db, const StatePtr& state) mutable {
+        // CallAfter copies its functor, so the result travels in a shared pointer
+        auto result = std::make_shared<Result>(work(db));
+        Complete(state, [onDone, result]() mutable { onDone(*result); });
+    });
+}
+
+#endif // DB_WORKER_H
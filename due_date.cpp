@@ -0,0 +1,93 @@
+#include "due_date.h"
+
+// Conversions between day numbers and civil dates follow Howard Hinnant's
+// days_from_civil / civil_from_days, which count in 400-year eras so that
+// no floating point or lookup tables are needed.
+int DueDayFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+void CivilFromDueDay(int dueDay, int& year, int& month, int& day) {
+    dueDay += 719468;
+    const int era = (dueDay >= 0 ? dueDay : dueDay - 146096) / 146097;
+    const int dayOfEra = dueDay - era * 146097;
+    const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int monthIndex = (5 * dayOfYear + 2) / 153; // March = 0
+    day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+int DueDayFromDateTime(const wxDateTime& date) {
+    if (!date.IsValid()) {
+        return NO_DUE_DATE;
+    }
+    return DueDayFromCivil(date.GetYear(), date.GetMonth() + 1, date.GetDay());
+}
+
+wxDateTime DateTimeFromDueDay(int dueDay) {
+    if (dueDay == NO_DUE_DATE) {
+        return wxInvalidDateTime;
+    }
+
+    int year, month, day;
+    CivilFromDueDay(dueDay, year, month, day);
+    return wxDateTime(static_cast<wxDateTime::wxDateTime_t>(day),
+                      static_cast<wxDateTime::Month>(month - 1), year);
+}
+
+int TodayDueDay() {
+    return DueDayFromDateTime(wxDateTime::Today());
+}
+
+wxString FormatDueDay(int dueDay) {
+    if (dueDay == NO_DUE_DATE) {
+        return wxEmptyString;
+    }
+
+    int year, month, day;
+    CivilFromDueDay(dueDay, year, month, day);
+    return wxString::Format("%04d-%02d-%02d", year, month, day);
+}
+
+bool ParseDueDay(const wxString& text, int& dueDay) {
+    if (text.length() != 10 || text[4] != '-' || text[7] != '-') {
+        return false;
+    }
+
+    int fields[3] = { 0, 0, 0 };
+    const size_t starts[3] = { 0, 5, 8 };
+    const size_t lengths[3] = { 4, 2, 2 };
+
+    for (int i = 0; i < 3; ++i) {
+        for (size_t pos = starts[i]; pos < starts[i] + lengths[i]; ++pos) {
+            const int c = static_cast<int>(text[pos].GetValue());
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            fields[i] = fields[i] * 10 + (c - '0');
+        }
+    }
+
+    int year = fields[0], month = fields[1], day = fields[2];
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+
+    // Reject days past the end of the month, e.g. 2023-02-29
+    int parsed = DueDayFromCivil(year, month, day);
+    int checkYear, checkMonth, checkDay;
+    CivilFromDueDay(parsed, checkYear, checkMonth, checkDay);
+    if (checkMonth != month || checkDay != day) {
+        return false;
+    }
+
+    dueDay = parsed;
+    return true;
+}
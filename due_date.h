@@ -0,0 +1,30 @@
+#ifndef DUE_DATE_H
+#define DUE_DATE_H
+
+#include <wx/wx.h>
+#include <wx/datetime.h>
+#include <climits>
+
+// Due dates are stored and carried as day numbers: days since 1970-01-01
+// in the proleptic Gregorian calendar. Comparing, sorting and adding days
+// are plain integer operations; text and wxDateTime are only produced at
+// the edges (display, date pickers, CSV files).
+
+// Day number of a task without a due date (NULL in the database)
+const int NO_DUE_DATE = INT_MIN;
+
+int DueDayFromCivil(int year, int month, int day);
+void CivilFromDueDay(int dueDay, int& year, int& month, int& day);
+
+int DueDayFromDateTime(const wxDateTime& date);
+// wxInvalidDateTime for NO_DUE_DATE
+wxDateTime DateTimeFromDueDay(int dueDay);
+int TodayDueDay();
+
+// YYYY-MM-DD, or an empty string for NO_DUE_DATE
+wxString FormatDueDay(int dueDay);
+// Accepts YYYY-MM-DD with a valid day of the month; returns false and
+// leaves dueDay unchanged otherwise
+bool ParseDueDay(const wxString& text, int& dueDay);
+
+#endif // DUE_DATE_H
@@ -14,7 +14,13 @@
 #include <wx/chartype.h>
 #include <wx/colordlg.h>
 #include <wx/combobox.h>
+#include <wx/progdlg.h>
+#include <wx/srchctrl.h>
+#include <wx/numdlg.h>
+#include <wx/choicdlg.h>
+#include <wx/timer.h>
 #include "wxsqlite3/wxsqlite3.h"
+#include <wx/cmdline.h>
 #include <vector>
 #include <string>
 #include <memory>
@@ -26,215 +32,30 @@
 #include "category_manager.h"
 #include "profile_dialog.h"
 #include "category_list_dialog.h"
-
-// Enhanced Task data structure
-struct Task {
-  int id;
-  wxString title;
-  wxString description;
-  wxString dueDate;
-  int priority;
-  bool completed;
-  int categoryId;
-  wxString categoryName;
-  wxString categoryColor;
-  int userId; // Owner of the task
-};
-
-// Enhanced Database Manager class
-class DatabaseManager {
-private:
-  wxSQLite3Database db;
-  bool isConnected;
-
-public:
-  DatabaseManager() : isConnected(false) {}
-
-  bool Connect(const wxString& dbPath) {
-    try {
-        std::cout << "Attempting to open database: " << dbPath.ToStdString() << std::endl;
-        
-        // Check if the database file exists
-        bool fileExists = wxFileExists(dbPath);
-        std::cout << "Database file exists: " << (fileExists ? "yes" : "no") << std::endl;
-        
-        // Open the database using wxSQLite3Database's method
-        db.Open(dbPath);
-        isConnected = true;
-        std::cout << "Database connected successfully" << std::endl;
-        
-        // Enable foreign keys
-        db.ExecuteUpdate("PRAGMA foreign_keys = ON");
-        
-        // Create tables if they don't exist
-        std::cout << "Creating tables if they don't exist" << std::endl;
-        db.ExecuteUpdate(
-            "CREATE TABLE IF NOT EXISTS tasks ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-            "title TEXT NOT NULL, "
-            "description TEXT, "
-            "due_date TEXT, "
-            "priority INTEGER, "
-            "completed INTEGER DEFAULT 0, "
-            "category_id INTEGER, "
-            "user_id INTEGER, "
-            "FOREIGN KEY(category_id) REFERENCES categories(id), "
-            "FOREIGN KEY(user_id) REFERENCES users(id))"
-        );
-        std::cout << "Tables created successfully" << std::endl;
-        
-        return true;
-    } catch (wxSQLite3Exception& e) {
-        std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
-        wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
-        isConnected = false;
-        return false;
-    }
-}
-
-  bool IsConnected() const {
-      return isConnected;
-  }
-
-  wxSQLite3Database* GetDatabase() {
-      return &db;
-  }
-
-  std::vector<Task> GetAllTasks(int userId, bool includeCompleted = true) {
-      std::vector<Task> results;
-      
-      try {
-          wxString sql = 
-              "SELECT t.id, t.title, t.description, t.due_date, t.priority, t.completed, "
-              "t.category_id, c.name as category_name, c.color as category_color "
-              "FROM tasks t "
-              "LEFT JOIN categories c ON t.category_id = c.id "
-              "WHERE t.user_id = ? ";
-          
-          if (!includeCompleted) {
-              sql += "AND t.completed = 0 ";
-          }
-          
-          sql += "ORDER BY t.due_date, t.priority DESC";
-          
-          wxSQLite3Statement stmt = db.PrepareStatement(sql);
-          stmt.Bind(1, userId);
-          stmt.Reset();
-          wxSQLite3ResultSet set = stmt.ExecuteQuery();
-          
-          while (set.NextRow()) {
-              Task task;
-              task.id = set.GetAsInt(0);
-              task.title = set.GetAsString(1);
-              task.description = set.GetAsString(2);
-              task.dueDate = set.GetAsString(3);
-              task.priority = set.GetAsInt(4);
-              task.completed = set.GetAsInt(5) != 0;
-              task.categoryId = set.IsNull(6) ? -1 : set.GetAsInt(6);
-              task.categoryName = set.IsNull(7) ? "No Category" : set.GetAsString(7);
-              task.categoryColor = set.IsNull(8) ? "#FFFFFF" : set.GetAsString(8);
-              task.userId = userId;
-              
-              results.push_back(task);
-          }
-      } catch (wxSQLite3Exception& e) {
-          std::cerr << "Query error: " << e.GetMessage().ToStdString() << std::endl;
-          wxMessageBox(e.GetMessage(), "Query Error", wxOK | wxICON_ERROR);
-      }
-      
-      return results;
-  }
-
-  bool AddTask(const wxString& title, const wxString& description, 
-             const wxString& dueDate, int priority, int categoryId, int userId) {
-      try {
-          wxSQLite3Statement stmt = db.PrepareStatement(
-              "INSERT INTO tasks (title, description, due_date, priority, category_id, user_id) "
-              "VALUES (?, ?, ?, ?, ?, ?)"
-          );
-          
-          stmt.Bind(1, title);
-          stmt.Bind(2, description);
-          stmt.Bind(3, dueDate);
-          stmt.Bind(4, priority);
-          
-          if (categoryId > 0) {
-              stmt.Bind(5, categoryId);
-          } else {
-              stmt.BindNull(5);
-          }
-          
-          stmt.Bind(6, userId);
-          
-          stmt.ExecuteUpdate();
-          return true;
-      } catch (wxSQLite3Exception& e) {
-          std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
-          wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
-          return false;
-      }
-  }
-
-  bool UpdateTask(int id, const wxString& title, const wxString& description, 
-                const wxString& dueDate, int priority, bool completed, int categoryId) {
-      try {
-          wxSQLite3Statement stmt = db.PrepareStatement(
-              "UPDATE tasks SET title = ?, description = ?, due_date = ?, "
-              "priority = ?, completed = ?, category_id = ? WHERE id = ?"
-          );
-          
-          stmt.Bind(1, title);
-          stmt.Bind(2, description);
-          stmt.Bind(3, dueDate);
-          stmt.Bind(4, priority);
-          stmt.Bind(5, completed ? 1 : 0);
-          
-          if (categoryId > 0) {
-              stmt.Bind(6, categoryId);
-          } else {
-              stmt.BindNull(6);
-          }
-          
-          stmt.Bind(7, id);
-          
-          stmt.ExecuteUpdate();
-          return true;
-      } catch (wxSQLite3Exception& e) {
-          std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
-          wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
-          return false;
-      }
-  }
-
-  bool DeleteTask(int id) {
-      try {
-          wxSQLite3Statement stmt = db.PrepareStatement("DELETE FROM tasks WHERE id = ?");
-          stmt.Bind(1, id);
-          stmt.ExecuteUpdate();
-          return true;
-      } catch (wxSQLite3Exception& e) {
-          std::cerr << "Database error: " << e.GetMessage().ToStdString() << std::endl;
-          wxMessageBox(e.GetMessage(), "Database Error", wxOK | wxICON_ERROR);
-          return false;
-      }
-  }
-
-  ~DatabaseManager() {
-      if (isConnected) {
-          db.Close();
-      }
-  }
-};
+#include "database_manager.h"
+#include "task_importer.h"
+#include "task_grid_table.h"
+#include "connection_pool.h"
+#include "task_searcher.h"
+#include "db_worker.h"
 
 // Main application class
 class TaskManagerApp : public wxApp {
 private:
+  // Declared first so that it outlives every connection it is attached to
+  std::unique_ptr<wxSQLite3Profiler> queryProfiler;
+  // Declared before dbManager, which flushes queued writes when destroyed
+  std::unique_ptr<CategoryManager> categoryManager;
   std::unique_ptr<DatabaseManager> dbManager;
   std::unique_ptr<UserManager> userManager;
-  std::unique_ptr<CategoryManager> categoryManager;
+  wxString dbProfile; // --db-profile, overrides taskmanager.ini
+  bool checkStats = false; // --check-stats, verify and repair task_stats
+  bool profileQueries = false; // --profile-queries, record query statistics from startup
 
 public:
   virtual bool OnInit() override;
+  virtual void OnInitCmdLine(wxCmdLineParser& parser) override;
+  virtual bool OnCmdLineParsed(wxCmdLineParser& parser) override;
 };
 
 // Forward declaration for TaskDetailDialog
@@ -248,7 +69,9 @@ private:
   wxPanel* tasksPanel;
   wxPanel* settingsPanel;
   
+  wxSearchCtrl* searchBox;
   wxGrid* tasksGrid;
+  TaskGridTable* taskTable;
   wxTextCtrl* titleCtrl;
   wxTextCtrl* descriptionCtrl;
   wxDatePickerCtrl* dueDateCtrl;
@@ -259,6 +82,12 @@ private:
   wxButton* updateButton;
   wxButton* deleteButton;
   
+  // Act on every task selected in the grid
+  wxButton* batchCompleteButton;
+  wxButton* batchDeleteButton;
+  wxButton* batchPriorityButton;
+  wxButton* batchCategoryButton;
+  
   wxMenuItem* logoutMenuItem;
   wxMenuItem* profileMenuItem;
   wxMenuItem* categoriesMenuItem;
@@ -266,8 +95,33 @@ private:
   DatabaseManager* dbManager;
   UserManager* userManager;
   CategoryManager* categoryManager;
-  
-  std::vector<Task> tasks;
+  // Attached to every connection while query statistics are recorded
+  wxSQLite3Profiler* queryProfiler;
+  
+  // Rows shown in the tasks grid: the paged task listing, or search results
+  std::unique_ptr<TaskRowSource> taskSource;
+  TaskFilter taskFilter;
+  
+  // Reader connections for searcher and dbWorker; declared first so that
+  // it outlives both
+  std::unique_ptr<ConnectionPool> readerPool;
+  
+  // Search-as-you-type: keystrokes restart searchTimer, which submits the
+  // search box text to searcher once typing pauses. Result batches are
+  // appended to liveResults while it is the displayed source.
+  static const int SEARCH_DELAY_MS = 250;
+  wxTimer searchTimer;
+  std::unique_ptr<TaskSearcher> searcher;
+  unsigned liveGeneration;
+  StoredTaskSource* liveResults;
+  
+  // Dashboard refreshes and exports run on dbWorker; a request still in
+  // flight is cancelled when it is replaced
+  std::unique_ptr<DbWorker> dbWorker;
+  DbRequest statsRequest;
+  DbRequest recentRequest;
+  DbRequest exportRequest;
+  std::vector<Task> recentTasks;
   std::vector<Category> categories;
   int selectedTaskId;
   
@@ -280,7 +134,9 @@ private:
 
 public:
   MainFrame(const wxString& title, DatabaseManager* dbManager, 
-           UserManager* userManager, CategoryManager* categoryManager);
+           UserManager* userManager, CategoryManager* categoryManager,
+           wxSQLite3Profiler* queryProfiler);
+  virtual ~MainFrame();
 
   void CreateMenuBar();
   void CreateDashboardPanel(wxPanel* panel);
@@ -290,14 +146,25 @@ public:
   void UpdateDashboardStatistics();
   void LoadTasks();
   void LoadCategories();
-  void DisplayTasks();
+  void DisplayTasks(std::unique_ptr<TaskRowSource> source);
+  void ApplyTaskChange(const TaskChange& change);
+  void QueueTaskUpdate(const Task& task);
+  TaskWriteCallback OnTaskWritten(const wxString& done);
+  std::vector<int> GetSelectedTaskIds();
+  void EditSelectedTasks(const TaskBatchEdit& edit);
   void DisplayRecentTasks();
   void ClearForm();
+  void StartLiveSearch();
+  void OnLiveSearchResults(unsigned generation, TaskStore& batch, bool done);
   
   void OnTaskSelect(wxGridEvent& event);
   void OnAddTask(wxCommandEvent& event);
   void OnUpdateTask(wxCommandEvent& event);
   void OnDeleteTask(wxCommandEvent& event);
+  void OnBatchComplete(wxCommandEvent& event);
+  void OnBatchDelete(wxCommandEvent& event);
+  void OnBatchPriority(wxCommandEvent& event);
+  void OnBatchCategory(wxCommandEvent& event);
   void OnTaskDetail(wxGridEvent& event);
   void OnExportTasks(wxCommandEvent& event);
   void OnImportTasks(wxCommandEvent& event);
@@ -308,6 +175,12 @@ public:
   void OnAbout(wxCommandEvent& event);
   void OnSearchTasks(wxCommandEvent& event);
   void OnToggleCompleted(wxCommandEvent& event);
+  void OnSearchText(wxCommandEvent& event);
+  void OnSearchCancel(wxCommandEvent& event);
+  void OnSearchTimer(wxTimerEvent& event);
+  void OnRecordQueryStats(wxCommandEvent& event);
+  void OnShowQueryStats(wxCommandEvent& event);
+  void OnSaveQueryStats(wxCommandEvent& event);
   
   // IDs for menu items and controls
   enum {
@@ -317,7 +190,13 @@ public:
       ID_EXPORT_TASKS,
       ID_IMPORT_TASKS,
       ID_SEARCH_TASKS,
-      ID_TOGGLE_COMPLETED
+      ID_TOGGLE_COMPLETED,
+      ID_SEARCH_BOX,
+      ID_SEARCH_TIMER,
+      ID_BATCH_COMPLETE,
+      ID_BATCH_DELETE,
+      ID_BATCH_PRIORITY,
+      ID_BATCH_CATEGORY
   };
   
   wxDECLARE_EVENT_TABLE();
@@ -330,6 +209,10 @@ wxBEGIN_EVENT_TABLE(MainFrame, wxFrame)
   EVT_BUTTON(wxID_ADD, MainFrame::OnAddTask)
   EVT_BUTTON(wxID_SAVE, MainFrame::OnUpdateTask)
   EVT_BUTTON(wxID_DELETE, MainFrame::OnDeleteTask)
+  EVT_BUTTON(ID_BATCH_COMPLETE, MainFrame::OnBatchComplete)
+  EVT_BUTTON(ID_BATCH_DELETE, MainFrame::OnBatchDelete)
+  EVT_BUTTON(ID_BATCH_PRIORITY, MainFrame::OnBatchPriority)
+  EVT_BUTTON(ID_BATCH_CATEGORY, MainFrame::OnBatchCategory)
   EVT_MENU(ID_LOGOUT, MainFrame::OnLogout)
   EVT_MENU(ID_PROFILE, MainFrame::OnProfile)
   EVT_MENU(ID_MANAGE_CATEGORIES, MainFrame::OnManageCategories)
@@ -339,6 +222,9 @@ wxBEGIN_EVENT_TABLE(MainFrame, wxFrame)
   EVT_MENU(wxID_ABOUT, MainFrame::OnAbout)
   EVT_MENU(ID_SEARCH_TASKS, MainFrame::OnSearchTasks)
   EVT_MENU(ID_TOGGLE_COMPLETED, MainFrame::OnToggleCompleted)
+  EVT_TEXT(ID_SEARCH_BOX, MainFrame::OnSearchText)
+  EVT_SEARCHCTRL_CANCEL_BTN(ID_SEARCH_BOX, MainFrame::OnSearchCancel)
+  EVT_TIMER(ID_SEARCH_TIMER, MainFrame::OnSearchTimer)
 wxEND_EVENT_TABLE()
 
 // Task Detail Dialog
@@ -353,7 +239,6 @@ private:
   wxCheckBox* completedCtrl;
   wxComboBox* categoryCombo;
   
-  DatabaseManager* dbManager;
   CategoryManager* categoryManager;
   int userId;
   std::vector<Category> categories;
@@ -364,7 +249,7 @@ private:
   void LoadCategories();
   
 public:
-  TaskDetailDialog(wxWindow* parent, Task* task, DatabaseManager* dbManager, 
+  TaskDetailDialog(wxWindow* parent, Task* task,
                   CategoryManager* categoryManager, int userId);
   virtual ~TaskDetailDialog();
   
@@ -378,11 +263,11 @@ wxBEGIN_EVENT_TABLE(TaskDetailDialog, wxDialog)
   EVT_BUTTON(wxID_CANCEL, TaskDetailDialog::OnCancelButton)
 wxEND_EVENT_TABLE()
 
-TaskDetailDialog::TaskDetailDialog(wxWindow* parent, Task* task, DatabaseManager* dbManager, 
+TaskDetailDialog::TaskDetailDialog(wxWindow* parent, Task* task,
                                CategoryManager* categoryManager, int userId)
   : wxDialog(parent, wxID_ANY, "Task Details", wxDefaultPosition, wxSize(500, 400),
             wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
-    task(task), dbManager(dbManager), categoryManager(categoryManager), userId(userId) {
+    task(task), categoryManager(categoryManager), userId(userId) {
   
   // Add validation
   if (!task) {
@@ -411,9 +296,7 @@ TaskDetailDialog::TaskDetailDialog(wxWindow* parent, Task* task, DatabaseManager
   
   // Due Date
   formSizer->Add(new wxStaticText(this, wxID_ANY, "Due Date:"), 0, wxALIGN_CENTER_VERTICAL);
-  wxDateTime dueDate;
-  dueDate.ParseISODate(task->dueDate);
-  dueDateCtrl = new wxDatePickerCtrl(this, wxID_ANY, dueDate);
+  dueDateCtrl = new wxDatePickerCtrl(this, wxID_ANY, DateTimeFromDueDay(task->dueDay));
   formSizer->Add(dueDateCtrl, 0, wxEXPAND);
   
   // Priority
@@ -500,24 +383,17 @@ void TaskDetailDialog::OnSaveButton(wxCommandEvent& event) {
       return;
   }
   
-  wxString dueDateStr = dueDate.FormatISODate();
+  int dueDay = DueDayFromDateTime(dueDate);
   
   // Update task object
   task->title = title;
   task->description = description;
-  task->dueDate = dueDateStr;
+  task->dueDay = dueDay;
   task->priority = priority;
   task->completed = completed;
   task->categoryId = categoryId;
   
-  // Update task in database if it already exists
-  if (task->id > 0) {
-      if (!dbManager->UpdateTask(task->id, title, description, dueDateStr, priority, completed, categoryId)) {
-          wxMessageBox("Failed to update task.", "Error", wxOK | wxICON_ERROR, this);
-          return;
-      }
-  }
-  
+  // The caller saves the edited task
   EndModal(wxID_OK);
 }
 
@@ -541,7 +417,7 @@ private:
   int userId;
   std::vector<Category> categories;
   
-  std::vector<Task>* searchResults;
+  TaskStore* searchResults;
   
   void OnSearchButton(wxCommandEvent& event);
   void OnCancelButton(wxCommandEvent& event);
@@ -552,7 +428,7 @@ private:
 public:
   SearchDialog(wxWindow* parent, DatabaseManager* dbManager, 
               CategoryManager* categoryManager, int userId, 
-              std::vector<Task>* results);
+              TaskStore* results);
   virtual ~SearchDialog();
   
   bool PerformSearch();
@@ -568,7 +444,7 @@ wxEND_EVENT_TABLE()
 
 SearchDialog::SearchDialog(wxWindow* parent, DatabaseManager* dbManager, 
                        CategoryManager* categoryManager, int userId, 
-                       std::vector<Task>* results)
+                       TaskStore* results)
   : wxDialog(parent, wxID_ANY, "Search Tasks", wxDefaultPosition, wxSize(450, 400),
             wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
     dbManager(dbManager), categoryManager(categoryManager), 
@@ -692,113 +568,22 @@ bool SearchDialog::PerformSearch() {
       categoryId = (int)(wxIntPtr)categoryCombo->GetClientData(selection);
   }
   
-  // Convert dates to ISO format
-  wxString fromDateStr = fromDate.FormatISODate();
-  wxString toDateStr = toDate.FormatISODate();
-  
-  // Build SQL query
-  wxString sql = 
-      "SELECT t.id, t.title, t.description, t.due_date, t.priority, t.completed, "
-      "t.category_id, c.name as category_name, c.color as category_color "
-      "FROM tasks t "
-      "LEFT JOIN categories c ON t.category_id = c.id "
-      "WHERE t.user_id = ? ";
-  
-  // Search text condition
-  if (!searchText.IsEmpty()) {
-      switch(fieldIndex) {
-          case 0: // Title
-              sql += "AND t.title LIKE ? ";
-              break;
-          case 1: // Description
-              sql += "AND t.description LIKE ? ";
-              break;
-          case 2: // All Fields
-              sql += "AND (t.title LIKE ? OR t.description LIKE ?) ";
-              break;
-      }
-  }
-  
-  // Priority condition
-  if (priorityIndex > 0) {
-      sql += "AND t.priority = ? ";
-  }
-  
-  // Date range condition
-  sql += "AND t.due_date BETWEEN ? AND ? ";
-  
-  // Category condition
-  if (categoryId == 0) { // No Category
-      sql += "AND t.category_id IS NULL ";
-  } else if (categoryId > 0) { // Specific Category
-      sql += "AND t.category_id = ? ";
-  }
-  
-  // Completed status condition
-  if (!includeCompleted) {
-      sql += "AND t.completed = 0 ";
-  }
-  
-  sql += "ORDER BY t.due_date, t.priority DESC";
-  
-  try {
-      wxSQLite3Statement stmt = dbManager->GetDatabase()->PrepareStatement(sql);
-      int paramIndex = 1;
-      
-      // Bind user ID
-      stmt.Bind(paramIndex++, userId);
-      
-      // Bind search text
-      if (!searchText.IsEmpty()) {
-          wxString likePattern = "%" + searchText + "%";
-          stmt.Bind(paramIndex++, likePattern);
-          
-          if (fieldIndex == 2) { // All Fields - need to bind twice
-              stmt.Bind(paramIndex++, likePattern);
-          }
-      }
-      
-      // Bind priority
-      if (priorityIndex > 0) {
-          stmt.Bind(paramIndex++, priorityIndex);
-      }
-      
-      // Bind date range
-      stmt.Bind(paramIndex++, fromDateStr);
-      stmt.Bind(paramIndex++, toDateStr);
-      
-      // Bind category ID
-      if (categoryId > 0) {
-          stmt.Bind(paramIndex++, categoryId);
-      }
-      
-      wxSQLite3ResultSet resultSet = stmt.ExecuteQuery();
-      
-      searchResults->clear();
-      
-      while (resultSet.NextRow()) {
-          Task task;
-          task.id = resultSet.GetAsInt(0);
-          task.title = resultSet.GetAsString(1);
-          task.description = resultSet.GetAsString(2);
-          task.dueDate = resultSet.GetAsString(3);
-          task.priority = resultSet.GetAsInt(4);
-          task.completed = resultSet.GetAsInt(5) != 0;
-          task.categoryId = resultSet.IsNull(6) ? -1 : resultSet.GetAsInt(6);
-          task.categoryName = resultSet.IsNull(7) ? "No Category" : resultSet.GetAsString(7);
-          task.categoryColor = resultSet.IsNull(8) ? "#FFFFFF" : resultSet.GetAsString(8);
-          task.userId = userId;
-          
-          searchResults->push_back(task);
-      }
-      
-      return true;
-  }
-  catch (wxSQLite3Exception& e) {
-      std::cerr << "Search error: " << e.GetMessage().ToStdString() << std::endl;
-      wxMessageBox(e.GetMessage(), "Search Error", wxOK | wxICON_ERROR);
+  TaskSearch search;
+  search.text = searchText;
+  search.field = fieldIndex == 0 ? TaskSearch::TITLE
+               : fieldIndex == 1 ? TaskSearch::DESCRIPTION
+               : TaskSearch::ALL_FIELDS;
+  search.priority = priorityIndex;
+  search.fromDay = DueDayFromDateTime(fromDate);
+  search.toDay = DueDayFromDateTime(toDate);
+  search.categoryId = categoryId;
+  search.includeCompleted = includeCompleted;
+  
+  if (!dbManager->SearchTasks(userId, search, *searchResults)) {
+      wxMessageBox("The search could not be completed.", "Search Error", wxOK | wxICON_ERROR);
       return false;
   }
+  return true;
 }
 
 void SearchDialog::OnSearchButton(wxCommandEvent& event) {
@@ -820,13 +605,25 @@ bool TaskManagerApp::OnInit() {
 
   // Initialize database
   dbManager = std::make_unique<DatabaseManager>();
-  if (!dbManager->Connect("taskmanager.db")) {
+  DatabaseTuning tuning = DatabaseTuning::Load("taskmanager.ini", dbProfile);
+  queryProfiler = std::make_unique<wxSQLite3Profiler>();
+  if (profileQueries) {
+      dbManager->GetDatabase()->SetProfiler(queryProfiler.get());
+  }
+  if (!dbManager->Connect("taskmanager.db", tuning)) {
       wxMessageBox("Failed to connect to database.", "Error", wxOK | wxICON_ERROR);
       return false;
   }
   
   std::cout << "Database connected successfully" << std::endl;
   
+  if (checkStats) {
+      std::vector<TaskStatsMismatch> mismatches;
+      if (dbManager->CheckTaskStats(mismatches, true)) {
+          std::cout << "task_stats check: " << mismatches.size() << " mismatched users" << std::endl;
+      }
+  }
+  
   // Initialize user manager
   std::cout << "Initializing user manager" << std::endl;
   userManager = std::make_unique<UserManager>(dbManager->GetDatabase());
@@ -845,21 +642,46 @@ bool TaskManagerApp::OnInit() {
   // Initialize category manager
   std::cout << "Initializing category manager" << std::endl;
   categoryManager = std::make_unique<CategoryManager>(dbManager->GetDatabase());
+  dbManager->SetCategoryManager(categoryManager.get());
 
   // Create main frame
   std::cout << "Creating main frame" << std::endl;
-  MainFrame* frame = new MainFrame("Task Manager", dbManager.get(), userManager.get(), categoryManager.get());
+  MainFrame* frame = new MainFrame("Task Manager", dbManager.get(), userManager.get(), categoryManager.get(),
+                                   queryProfiler.get());
   frame->Show(true);
   
   std::cout << "Application initialization complete" << std::endl;
   return true;
 }
 
+void TaskManagerApp::OnInitCmdLine(wxCmdLineParser& parser) {
+  wxApp::OnInitCmdLine(parser);
+  parser.AddOption("", "db-profile", 
+                   "Database tuning profile: durable, balanced (default) or bulk");
+  parser.AddSwitch("", "check-stats", 
+                   "Verify the dashboard counters against the tasks table and repair them");
+  parser.AddSwitch("", "profile-queries", 
+                   "Record query statistics from startup; see Settings > Diagnostics");
+}
+
+bool TaskManagerApp::OnCmdLineParsed(wxCmdLineParser& parser) {
+  if (!wxApp::OnCmdLineParsed(parser))
+      return false;
+  
+  parser.Found("db-profile", &dbProfile);
+  checkStats = parser.Found("check-stats");
+  profileQueries = parser.Found("profile-queries");
+  return true;
+}
+
 // Main frame implementation
 MainFrame::MainFrame(const wxString& title, DatabaseManager* dbManager, 
-                 UserManager* userManager, CategoryManager* categoryManager)
+                 UserManager* userManager, CategoryManager* categoryManager,
+                 wxSQLite3Profiler* queryProfiler)
   : wxFrame(nullptr, wxID_ANY, title, wxDefaultPosition, wxSize(900, 700)),
     dbManager(dbManager), userManager(userManager), categoryManager(categoryManager), 
+    queryProfiler(queryProfiler), 
+    searchTimer(this, ID_SEARCH_TIMER), liveGeneration(0), liveResults(nullptr),
     selectedTaskId(-1) {
   
   std::cout << "MainFrame constructor - Creating menu bar" << std::endl;
@@ -895,6 +717,25 @@ MainFrame::MainFrame(const wxString& title, DatabaseManager* dbManager,
   mainSizer->Add(notebook, 1, wxEXPAND | wxALL, 5);
   SetSizer(mainSizer);
   
+  // Background reads use pooled reader connections, so they see a
+  // consistent snapshot and never wait behind writes on dbManager
+  readerPool = std::make_unique<ConnectionPool>(dbManager);
+  readerPool->Open();
+  
+  // Live search queries run on a reader; without one they run on the UI
+  // thread
+  searcher = std::make_unique<TaskSearcher>(this, readerPool.get(),
+      [this](unsigned generation, TaskStore& batch, bool done) {
+          OnLiveSearchResults(generation, batch, done);
+      });
+  if (!searcher->Start()) {
+      std::cerr << "Search worker unavailable, searching on the UI thread" << std::endl;
+      searcher.reset();
+  }
+  
+  dbWorker = std::make_unique<DbWorker>(this, readerPool.get());
+  dbWorker->Start();
+  
   std::cout << "Loading categories and tasks" << std::endl;
   // Load tasks and categories
   LoadCategories();
@@ -903,6 +744,12 @@ MainFrame::MainFrame(const wxString& title, DatabaseManager* dbManager,
   std::cout << "MainFrame constructor complete" << std::endl;
 }
 
+MainFrame::~MainFrame() {
+  // Commit queued edits while the grid they update still exists; the
+  // dashboard refreshes they request are cancelled with dbWorker
+  dbManager->FlushWrites();
+}
+
 void MainFrame::CreateMenuBar() {
   wxMenuBar* menuBar = new wxMenuBar;
   
@@ -1053,7 +900,7 @@ void MainFrame::CreateDashboardPanel(wxPanel* panel) {
       
       // Find the task
       Task* selectedTask = nullptr;
-      for (auto& task : tasks) {
+      for (auto& task : recentTasks) {
           if (task.id == taskId) {
               selectedTask = &task;
               break;
@@ -1061,11 +908,12 @@ void MainFrame::CreateDashboardPanel(wxPanel* panel) {
       }
       
       if (selectedTask) {
-          TaskDetailDialog dlg(this, selectedTask, dbManager, categoryManager, 
+          // recentTasks may be replaced while the dialog is open
+          Task task = *selectedTask;
+          TaskDetailDialog dlg(this, &task, categoryManager, 
                              userManager->GetCurrentUser()->id);
           if (dlg.ShowModal() == wxID_OK) {
-              LoadTasks();
-              UpdateDashboardStatistics();
+              QueueTaskUpdate(task);
           }
       }
   });
@@ -1074,15 +922,20 @@ void MainFrame::CreateDashboardPanel(wxPanel* panel) {
 void MainFrame::CreateTasksPanel(wxPanel* panel) {
   wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
   
+  // Search box, filters the grid as the user types
+  searchBox = new wxSearchCtrl(panel, ID_SEARCH_BOX);
+  searchBox->ShowCancelButton(true);
+  searchBox->SetDescriptiveText("Search tasks");
+  
   // Create tasks grid
   tasksGrid = new wxGrid(panel, wxID_ANY);
-  tasksGrid->CreateGrid(0, 6);
-  tasksGrid->SetColLabelValue(0, "ID");
-  tasksGrid->SetColLabelValue(1, "Title");
-  tasksGrid->SetColLabelValue(2, "Due Date");
-  tasksGrid->SetColLabelValue(3, "Priority");
-  tasksGrid->SetColLabelValue(4, "Category");
-  tasksGrid->SetColLabelValue(5, "Completed");
+  // The table reads rows from taskSource; the grid owns the table and
+  // the table owns the attribute provider
+  taskTable = new TaskGridTable();
+  taskTable->SetAttrProvider(new TaskGridAttrProvider(taskTable));
+  // Whole rows are selected, so that several tasks can be edited at once
+  tasksGrid->SetTable(taskTable, true, wxGrid::wxGridSelectRows);
+  tasksGrid->EnableEditing(false);
   
   tasksGrid->SetColSize(0, 50);
   tasksGrid->SetColSize(1, 200);
@@ -1091,6 +944,18 @@ void MainFrame::CreateTasksPanel(wxPanel* panel) {
   tasksGrid->SetColSize(4, 120);
   tasksGrid->SetColSize(5, 100);
   
+  // Batch actions on the selected rows
+  wxBoxSizer* batchSizer = new wxBoxSizer(wxHORIZONTAL);
+  batchCompleteButton = new wxButton(panel, ID_BATCH_COMPLETE, "Complete Selected");
+  batchDeleteButton = new wxButton(panel, ID_BATCH_DELETE, "Delete Selected");
+  batchPriorityButton = new wxButton(panel, ID_BATCH_PRIORITY, "Set Priority...");
+  batchCategoryButton = new wxButton(panel, ID_BATCH_CATEGORY, "Move to Category...");
+  
+  batchSizer->Add(batchCompleteButton, 0, wxRIGHT, 5);
+  batchSizer->Add(batchDeleteButton, 0, wxRIGHT, 5);
+  batchSizer->Add(batchPriorityButton, 0, wxRIGHT, 5);
+  batchSizer->Add(batchCategoryButton, 0);
+  
   // Create form for adding/editing tasks
   wxStaticBox* formBox = new wxStaticBox(panel, wxID_ANY, "Task Details");
   wxStaticBoxSizer* formSizer = new wxStaticBoxSizer(formBox, wxVERTICAL);
@@ -1147,7 +1012,9 @@ void MainFrame::CreateTasksPanel(wxPanel* panel) {
   formSizer->Add(buttonSizer, 0, wxALL | wxALIGN_RIGHT, 10);
   
   // Add to main sizer
+  mainSizer->Add(searchBox, 0, wxLEFT | wxRIGHT | wxTOP | wxEXPAND, 10);
   mainSizer->Add(tasksGrid, 1, wxALL | wxEXPAND, 10);
+  mainSizer->Add(batchSizer, 0, wxLEFT | wxRIGHT, 10);
   mainSizer->Add(formSizer, 0, wxALL | wxEXPAND, 10);
   
   panel->SetSizer(mainSizer);
@@ -1191,6 +1058,18 @@ void MainFrame::CreateSettingsPanel(wxPanel* panel) {
   dataSizer->Add(importButton, 0, wxALL | wxEXPAND, 5);
   dataSizer->Add(backupButton, 0, wxALL | wxEXPAND, 5);
   
+  wxStaticBox* diagnosticsBox = new wxStaticBox(panel, wxID_ANY, "Diagnostics");
+  wxStaticBoxSizer* diagnosticsSizer = new wxStaticBoxSizer(diagnosticsBox, wxVERTICAL);
+  
+  wxCheckBox* recordQueryStatsCheck = new wxCheckBox(diagnosticsBox, wxID_ANY, "Record Query Statistics");
+  recordQueryStatsCheck->SetValue(dbManager->GetDatabase()->GetProfiler() != nullptr);
+  wxButton* showQueryStatsButton = new wxButton(diagnosticsBox, wxID_ANY, "Show Query Statistics");
+  wxButton* saveQueryStatsButton = new wxButton(diagnosticsBox, wxID_ANY, "Save Query Statistics");
+  
+  diagnosticsSizer->Add(recordQueryStatsCheck, 0, wxALL, 5);
+  diagnosticsSizer->Add(showQueryStatsButton, 0, wxALL | wxEXPAND, 5);
+  diagnosticsSizer->Add(saveQueryStatsButton, 0, wxALL | wxEXPAND, 5);
+  
   wxStaticBox* accountBox = new wxStaticBox(panel, wxID_ANY, "Account");
   wxStaticBoxSizer* accountSizer = new wxStaticBoxSizer(accountBox, wxVERTICAL);
   
@@ -1207,6 +1086,7 @@ void MainFrame::CreateSettingsPanel(wxPanel* panel) {
   sizer->Add(appearanceSizer, 0, wxALL | wxEXPAND, 10);
   sizer->Add(notificationsSizer, 0, wxALL | wxEXPAND, 10);
   sizer->Add(dataSizer, 0, wxALL | wxEXPAND, 10);
+  sizer->Add(diagnosticsSizer, 0, wxALL | wxEXPAND, 10);
   sizer->Add(accountSizer, 0, wxALL | wxEXPAND, 10);
   sizer->Add(saveSettingsButton, 0, wxALL | wxALIGN_RIGHT, 10);
   
@@ -1217,6 +1097,9 @@ void MainFrame::CreateSettingsPanel(wxPanel* panel) {
   logoutButton->Bind(wxEVT_BUTTON, &MainFrame::OnLogout, this);
   exportButton->Bind(wxEVT_BUTTON, &MainFrame::OnExportTasks, this);
   importButton->Bind(wxEVT_BUTTON, &MainFrame::OnImportTasks, this);
+  recordQueryStatsCheck->Bind(wxEVT_CHECKBOX, &MainFrame::OnRecordQueryStats, this);
+  showQueryStatsButton->Bind(wxEVT_BUTTON, &MainFrame::OnShowQueryStats, this);
+  saveQueryStatsButton->Bind(wxEVT_BUTTON, &MainFrame::OnSaveQueryStats, this);
   changePasswordButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) {
       ProfileDialog dlg(this, userManager);
       dlg.ShowModal();
@@ -1224,42 +1107,37 @@ void MainFrame::CreateSettingsPanel(wxPanel* panel) {
 }
 
 void MainFrame::UpdateDashboardStatistics() {
-  int totalTasks = tasks.size();
-  int completedTasks = 0;
-  int pendingTasks = 0;
-  int urgentTasks = 0;
-  
-  wxDateTime today = wxDateTime::Today();
-  wxDateTime nextWeek = today.Add(wxDateSpan::Days(7));
+  int userId = userManager->GetCurrentUser()->id;
   
-  for (const auto& task : tasks) {
-      if (task.completed) {
-          completedTasks++;
-      } else {
-          pendingTasks++;
-          
-          // Check if task is due within the next week
-          wxDateTime dueDate;
-          dueDate.ParseISODate(task.dueDate);
-          
-          if (dueDate.IsValid() && dueDate <= nextWeek) {
-              urgentTasks++;
+  statsRequest.Cancel();
+  statsRequest = dbWorker->GetTaskStatistics(userId, wxDateTime::Today(),
+      [this](bool ok, TaskStatistics& stats) {
+          if (!ok) {
+              return;
           }
-      }
-  }
-  
-  totalTasksText->SetLabel(wxString::Format("%d", totalTasks));
-  completedTasksText->SetLabel(wxString::Format("%d", completedTasks));
-  pendingTasksText->SetLabel(wxString::Format("%d", pendingTasks));
-  urgentTasksText->SetLabel(wxString::Format("%d", urgentTasks));
-  
-  // Display recent tasks
-  DisplayRecentTasks();
+          totalTasksText->SetLabel(wxString::Format("%d", stats.total));
+          completedTasksText->SetLabel(wxString::Format("%d", stats.completed));
+          pendingTasksText->SetLabel(wxString::Format("%d", stats.pending));
+          urgentTasksText->SetLabel(wxString::Format("%d", stats.urgent));
+      });
+  
+  // Display at most 10 tasks, pending first and by due date (ascending)
+  recentRequest.Cancel();
+  recentRequest = dbWorker->GetRecentTasks(userId, 10,
+      [this](std::vector<Task>& tasks) {
+          recentTasks.swap(tasks);
+          DisplayRecentTasks();
+      });
 }
 
 void MainFrame::LoadTasks() {
-  tasks = dbManager->GetAllTasks(userManager->GetCurrentUser()->id);
-  DisplayTasks();
+  if (!searchBox->GetValue().Trim().IsEmpty()) {
+      StartLiveSearch();
+      return;
+  }
+  
+  DisplayTasks(std::unique_ptr<TaskRowSource>(
+      new PagedTaskSource(dbManager, userManager->GetCurrentUser()->id, taskFilter)));
 }
 
 void MainFrame::LoadCategories() {
@@ -1278,84 +1156,51 @@ void MainFrame::LoadCategories() {
   categoryCombo->SetSelection(0); // Default to "No Category"
 }
 
-void MainFrame::DisplayTasks() {
-  // Clear grid
-  if (tasksGrid->GetNumberRows() > 0) {
-      tasksGrid->DeleteRows(0, tasksGrid->GetNumberRows());
-  }
-  
-  // Add tasks to grid
-  tasksGrid->AppendRows(tasks.size());
-  
-  for (size_t i = 0; i < tasks.size(); ++i) {
-      const Task& task = tasks[i];
-      
-      tasksGrid->SetCellValue(i, 0, wxString::Format("%d", task.id));
-      tasksGrid->SetCellValue(i, 1, task.title);
-      tasksGrid->SetCellValue(i, 2, task.dueDate);
-      tasksGrid->SetCellValue(i, 3, wxString::Format("%d", task.priority));
-      tasksGrid->SetCellValue(i, 4, task.categoryName);
-      tasksGrid->SetCellValue(i, 5, task.completed ? "Yes" : "No");
-      
-      // Apply background color based on category
-      if (!task.categoryColor.IsEmpty()) {
-          wxColour color;
-          color.Set(task.categoryColor);
-          tasksGrid->SetCellBackgroundColour(i, 4, color);
-          
-          // Set text color to ensure readability
-          int brightness = (color.Red() * 299 + color.Green() * 587 + color.Blue() * 114) / 1000;
-          if (brightness > 128) {
-              tasksGrid->SetCellTextColour(i, 4, *wxBLACK);
-          } else {
-              tasksGrid->SetCellTextColour(i, 4, *wxWHITE);
-          }
-      }
-      
-      // Apply background color to completed tasks
-      if (task.completed) {
-          for (int col = 0; col < tasksGrid->GetNumberCols(); ++col) {
-              // Skip category cell which already has a color
-              if (col != 4 || task.categoryColor.IsEmpty()) {
-                  tasksGrid->SetCellBackgroundColour(i, col, wxColour(240, 240, 240));
-              }
-          }
-      }
-      
-      // Apply background color to high priority tasks (4-5)
-      if (task.priority >= 4 && !task.completed) {
-          tasksGrid->SetCellBackgroundColour(i, 3, wxColour(255, 200, 200));
+void MainFrame::DisplayTasks(std::unique_ptr<TaskRowSource> source) {
+  // Cells are formatted on demand by the table; the previous source is
+  // released only once the table no longer refers to it
+  taskTable->SetSource(source.get());
+  taskSource.swap(source);
+  liveResults = nullptr;
+}
+
+void MainFrame::ApplyTaskChange(const TaskChange& change) {
+  // Only the changed row moves in the grid; the dashboard counters come
+  // from task_stats and stay cheap to reread
+  taskTable->ApplyChange(change);
+  UpdateDashboardStatistics();
+}
+
+void MainFrame::QueueTaskUpdate(const Task& task) {
+  dbManager->QueueUpdateTask(task.id, task.title, task.description, task.dueDay, task.priority,
+                             task.completed, task.categoryId, OnTaskWritten("Task updated"));
+}
+
+TaskWriteCallback MainFrame::OnTaskWritten(const wxString& done) {
+  // Edits are committed in batches by the write queue, so success is
+  // reported in the status bar rather than a message box per edit;
+  // failures have already shown the database error
+  return [this, done](bool ok, const TaskChange& change) {
+      if (ok) {
+          SetStatusText(done);
+          ApplyTaskChange(change);
       }
-  }
-  
-  tasksGrid->AutoSize();
+  };
 }
 
 void MainFrame::DisplayRecentTasks() {
   recentTasksList->DeleteAllItems();
   
-  // Sort tasks by due date (ascending)
-  std::vector<Task> sortedTasks = tasks;
-  std::sort(sortedTasks.begin(), sortedTasks.end(), [](const Task& a, const Task& b) {
-      // Put completed tasks at the end
-      if (a.completed != b.completed) {
-          return !a.completed;
-      }
-      
-      // Sort by due date
-      return a.dueDate < b.dueDate;
-  });
-  
-  // Display at most 10 most recent tasks
-  int count = std::min(10, static_cast<int>(sortedTasks.size()));
+  int today = TodayDueDay();
+  int soon = today + 3;
   
-  for (int i = 0; i < count; ++i) {
-      const Task& task = sortedTasks[i];
+  for (size_t i = 0; i < recentTasks.size(); ++i) {
+      const Task& task = recentTasks[i];
       
       long itemIndex = recentTasksList->InsertItem(i, task.title);
-      recentTasksList->SetItem(itemIndex, 1, task.dueDate);
+      recentTasksList->SetItem(itemIndex, 1, FormatDueDay(task.dueDay));
       recentTasksList->SetItem(itemIndex, 2, wxString::Format("%d", task.priority));
-      recentTasksList->SetItem(itemIndex, 3, task.categoryName);
+      recentTasksList->SetItem(itemIndex, 3, task.category->name);
       recentTasksList->SetItem(itemIndex, 4, task.completed ? "Completed" : "Pending");
       
       // Store task ID in the item data
@@ -1366,14 +1211,10 @@ void MainFrame::DisplayRecentTasks() {
           recentTasksList->SetItemTextColour(itemIndex, wxColour(0, 128, 0)); // Green for completed
       } else {
           // Determine urgency based on due date
-          wxDateTime dueDate;
-          wxDateTime today = wxDateTime::Today();
-          dueDate.ParseISODate(task.dueDate);
-          
-          if (dueDate.IsValid()) {
-              if (dueDate < today) {
+          if (task.dueDay != NO_DUE_DATE) {
+              if (task.dueDay < today) {
                   recentTasksList->SetItemTextColour(itemIndex, wxColour(255, 0, 0)); // Red for overdue
-              } else if (dueDate <= today.Add(wxDateSpan::Days(3))) {
+              } else if (task.dueDay <= soon) {
                   recentTasksList->SetItemTextColour(itemIndex, wxColour(255, 128, 0)); // Orange for urgent
               }
           }
@@ -1399,20 +1240,20 @@ void MainFrame::OnTaskSelect(wxGridEvent& event) {
   int row = event.GetRow();
   
   // Add bounds checking
-  if (row < 0 || row >= static_cast<int>(tasks.size())) {
+  Task task;
+  if (!taskTable->GetTask(row, task)) {
       event.Skip();
       return;
   }
   
-  const Task& task = tasks[row];
+  // The grid rows carry no description; load it for the form
+  dbManager->GetTaskDescription(task.id, task.description);
   
   selectedTaskId = task.id;
   titleCtrl->SetValue(task.title);
   descriptionCtrl->SetValue(task.description);
   
-  wxDateTime dueDate;
-  dueDate.ParseISODate(task.dueDate);
-  dueDateCtrl->SetValue(dueDate);
+  dueDateCtrl->SetValue(DateTimeFromDueDay(task.dueDay));
   
   priorityCtrl->SetValue(task.priority);
   completedCtrl->SetValue(task.completed);
@@ -1452,15 +1293,11 @@ void MainFrame::OnAddTask(wxCommandEvent& event) {
       return;
   }
   
-  wxString dueDateStr = dueDate.FormatISODate();
+  int dueDay = DueDayFromDateTime(dueDate);
   
-  if (dbManager->AddTask(title, description, dueDateStr, priority, categoryId, 
-                       userManager->GetCurrentUser()->id)) {
-      wxMessageBox("Task added successfully.", "Success", wxOK | wxICON_INFORMATION);
-      ClearForm();
-      LoadTasks();
-      UpdateDashboardStatistics();
-  }
+  dbManager->QueueAddTask(title, description, dueDay, priority, categoryId, 
+                          userManager->GetCurrentUser()->id, OnTaskWritten("Task added"));
+  ClearForm();
 }
 
 void MainFrame::OnUpdateTask(wxCommandEvent& event) {
@@ -1486,14 +1323,11 @@ void MainFrame::OnUpdateTask(wxCommandEvent& event) {
       return;
   }
   
-  wxString dueDateStr = dueDate.FormatISODate();
+  int dueDay = DueDayFromDateTime(dueDate);
   
-  if (dbManager->UpdateTask(selectedTaskId, title, description, dueDateStr, priority, completed, categoryId)) {
-      wxMessageBox("Task updated successfully.", "Success", wxOK | wxICON_INFORMATION);
-      ClearForm();
-      LoadTasks();
-      UpdateDashboardStatistics();
-  }
+  dbManager->QueueUpdateTask(selectedTaskId, title, description, dueDay, priority, completed,
+                             categoryId, OnTaskWritten("Task updated"));
+  ClearForm();
 }
 
 void MainFrame::OnDeleteTask(wxCommandEvent& event) {
@@ -1505,44 +1339,121 @@ void MainFrame::OnDeleteTask(wxCommandEvent& event) {
       "Confirm Deletion", wxYES_NO | wxNO_DEFAULT | wxICON_QUESTION);
   
   if (dialog.ShowModal() == wxID_YES) {
-      if (dbManager->DeleteTask(selectedTaskId)) {
-          wxMessageBox("Task deleted successfully.", "Success", wxOK | wxICON_INFORMATION);
-          ClearForm();
-          LoadTasks();
-          UpdateDashboardStatistics();
+      dbManager->QueueDeleteTask(selectedTaskId, OnTaskWritten("Task deleted"));
+      ClearForm();
+  }
+}
+
+std::vector<int> MainFrame::GetSelectedTaskIds() {
+  std::vector<int> ids;
+  wxArrayInt rows = tasksGrid->GetSelectedRows();
+  for (size_t i = 0; i < rows.GetCount(); ++i) {
+      Task task;
+      if (taskTable->GetTask(rows[i], task)) {
+          ids.push_back(task.id);
       }
   }
+  
+  // A task picked in the form counts as selected too
+  if (ids.empty() && selectedTaskId >= 0) {
+      ids.push_back(selectedTaskId);
+  }
+  return ids;
+}
+
+void MainFrame::EditSelectedTasks(const TaskBatchEdit& edit) {
+  std::vector<int> ids = GetSelectedTaskIds();
+  if (ids.empty()) {
+      wxMessageBox("Select the tasks first.", "No Tasks Selected", wxOK | wxICON_INFORMATION);
+      return;
+  }
+  
+  // One transaction for the whole selection, then only the rows it
+  // changed move in the grid
+  std::vector<TaskChange> changes;
+  if (!dbManager->EditTasks(ids, edit, changes)) {
+      return;
+  }
+  
+  tasksGrid->ClearSelection();
+  ClearForm();
+  taskTable->ApplyChanges(changes);
+  UpdateDashboardStatistics();
+  SetStatusText(wxString::Format("%d tasks changed", (int)changes.size()));
+}
+
+void MainFrame::OnBatchComplete(wxCommandEvent& event) {
+  TaskBatchEdit edit = {TaskBatchEdit::COMPLETE, 0};
+  EditSelectedTasks(edit);
+}
+
+void MainFrame::OnBatchDelete(wxCommandEvent& event) {
+  std::vector<int> ids = GetSelectedTaskIds();
+  if (ids.empty()) {
+      wxMessageBox("Select the tasks first.", "No Tasks Selected", wxOK | wxICON_INFORMATION);
+      return;
+  }
+  
+  wxMessageDialog dialog(this, wxString::Format("Are you sure you want to delete %d tasks?", (int)ids.size()),
+      "Confirm Deletion", wxYES_NO | wxNO_DEFAULT | wxICON_QUESTION);
+  if (dialog.ShowModal() == wxID_YES) {
+      TaskBatchEdit edit = {TaskBatchEdit::REMOVE, 0};
+      EditSelectedTasks(edit);
+  }
+}
+
+void MainFrame::OnBatchPriority(wxCommandEvent& event) {
+  long priority = wxGetNumberFromUser("New priority for the selected tasks", "Priority:",
+                                      "Set Priority", 3, 1, 5, this);
+  if (priority < 0) {
+      return;
+  }
+  
+  TaskBatchEdit edit = {TaskBatchEdit::SET_PRIORITY, (int)priority};
+  EditSelectedTasks(edit);
+}
+
+void MainFrame::OnBatchCategory(wxCommandEvent& event) {
+  wxArrayString choices;
+  choices.Add("No Category");
+  for (const auto& category : categories) {
+      choices.Add(category.name);
+  }
+  
+  wxSingleChoiceDialog dialog(this, "Move the selected tasks to", "Move to Category", choices);
+  if (dialog.ShowModal() != wxID_OK) {
+      return;
+  }
+  
+  int selection = dialog.GetSelection();
+  TaskBatchEdit edit = {TaskBatchEdit::SET_CATEGORY, selection > 0 ? categories[selection - 1].id : -1};
+  EditSelectedTasks(edit);
 }
 
 void MainFrame::OnTaskDetail(wxGridEvent& event) {
   int row = event.GetRow();
   
-  if (row >= 0 && row < static_cast<int>(tasks.size())) {
-      Task& task = tasks[row];
+  Task task;
+  if (taskTable->GetTask(row, task)) {
+      dbManager->GetTaskDescription(task.id, task.description);
       
-      TaskDetailDialog dlg(this, &task, dbManager, categoryManager, 
+      TaskDetailDialog dlg(this, &task, categoryManager, 
                          userManager->GetCurrentUser()->id);
       if (dlg.ShowModal() == wxID_OK) {
-          LoadTasks();
-          UpdateDashboardStatistics();
+          QueueTaskUpdate(task);
       }
   }
 }
 
-void MainFrame::OnExportTasks(wxCommandEvent& event) {
-  wxFileDialog saveFileDialog(this, "Export Tasks", "", "",
-                             "CSV files (*.csv)|*.csv", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
-  
-  if (saveFileDialog.ShowModal() == wxID_CANCEL) {
-      return;
-  }
-  
-  wxString filePath = saveFileDialog.GetPath();
-  
+// Writes tasks as CSV: rows when given, otherwise the user's task listing
+// a page at a time. Runs on the database worker; returns the number of
+// tasks written, or -1 when the file cannot be written in full or a page
+// query fails.
+static int ExportTasksCsv(DatabaseManager& db, const wxString& filePath, int userId,
+                          const TaskFilter& filter, const TaskStore* rows) {
   wxFileOutputStream output(filePath);
   if (!output.IsOk()) {
-      wxLogError("Cannot save to file '%s'.", filePath);
-      return;
+      return -1;
   }
   
   wxTextOutputStream text(output);
@@ -1550,8 +1461,10 @@ void MainFrame::OnExportTasks(wxCommandEvent& event) {
   // Write header
   text << "ID,Title,Description,Due Date,Priority,Category,Completed\n";
   
-  // Write tasks
-  for (const auto& task : tasks) {
+  int exportedCount = 0;
+  auto writeTask = [&](const Task& task) {
+      exportedCount++;
+      
       // Format fields properly for CSV
       wxString title = task.title;
       title.Replace("\"", "\"\"");  // Escape quotes
@@ -1559,21 +1472,110 @@ void MainFrame::OnExportTasks(wxCommandEvent& event) {
       wxString description = task.description;
       description.Replace("\"", "\"\"");
       
-      wxString categoryName = task.categoryName;
+      wxString categoryName = task.category->name;
       categoryName.Replace("\"", "\"\"");
       
       text << task.id << ","
            << "\"" << title << "\","
            << "\"" << description << "\","
-           << task.dueDate << ","
+           << FormatDueDay(task.dueDay) << ","
            << task.priority << ","
            << "\"" << categoryName << "\","
            << (task.completed ? "Yes" : "No") << "\n";
+  };
+  
+  // A failed or cancelled query fails the export, which would otherwise
+  // look complete
+  const int pageSize = PagedTaskSource::DEFAULT_PAGE_SIZE;
+  if (rows != nullptr) {
+      // The rows carry no description; each page of them has its
+      // descriptions read in one query
+      Task task;
+      std::vector<int> ids;
+      std::unordered_map<int, wxString> descriptions;
+      for (size_t first = 0; first < rows->GetCount(); first += pageSize) {
+          size_t last = std::min(rows->GetCount(), first + pageSize);
+          ids.clear();
+          for (size_t row = first; row < last; ++row) {
+              ids.push_back(rows->GetId(row));
+          }
+          if (!db.GetTaskDescriptions(ids, descriptions)) {
+              return -1;
+          }
+          for (size_t row = first; row < last; ++row) {
+              rows->GetTask(row, task);
+              auto found = descriptions.find(task.id);
+              task.description = found != descriptions.end() ? found->second : wxString();
+              writeTask(task);
+          }
+      }
+  } else {
+      // An empty page ends the listing
+      std::vector<Task> page;
+      TaskKey lastKey;
+      const TaskKey* afterKey = nullptr;
+      for (;;) {
+          if (!db.GetTasksPageWithDescriptions(userId, filter, afterKey, pageSize, page)) {
+              return -1;
+          }
+          if (page.empty()) {
+              break;
+          }
+          for (const Task& task : page) {
+              writeTask(task);
+          }
+          lastKey = TaskKey::Of(page.back());
+          afterKey = &lastKey;
+      }
+  }
+  
+  // A full disk shows up as a failed write or close
+  text.Flush();
+  if (!output.IsOk() || !output.Close()) {
+      return -1;
+  }
+  return exportedCount;
+}
+
+void MainFrame::OnExportTasks(wxCommandEvent& event) {
+  wxFileDialog saveFileDialog(this, "Export Tasks", "", "",
+                             "CSV files (*.csv)|*.csv", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+  
+  if (saveFileDialog.ShowModal() == wxID_CANCEL) {
+      return;
   }
   
-  wxMessageBox(wxString::Format("Successfully exported %zu tasks to %s", 
-                              tasks.size(), filePath), 
-              "Export Complete", wxOK | wxICON_INFORMATION);
+  wxString filePath = saveFileDialog.GetPath();
+  
+  // The worker's connection only sees committed edits
+  dbManager->FlushWrites();
+  
+  // Search results are exported as held in memory; the listing is read
+  // again on the worker connection
+  std::shared_ptr<TaskStore> shownRows;
+  if (StoredTaskSource* stored = dynamic_cast<StoredTaskSource*>(taskSource.get())) {
+      shownRows = std::make_shared<TaskStore>(stored->GetTasks());
+  }
+  int userId = userManager->GetCurrentUser()->id;
+  TaskFilter filter = taskFilter;
+  
+  SetStatusText("Exporting tasks...");
+  exportRequest.Cancel();
+  exportRequest = dbWorker->Post(
+      [filePath, userId, filter, shownRows](DatabaseManager& db) {
+          return ExportTasksCsv(db, filePath, userId, filter, shownRows.get());
+      },
+      [this, filePath](int exportedCount) {
+          if (exportedCount < 0) {
+              SetStatusText("Export failed");
+              wxLogError("Could not export the tasks to '%s'; the file may be incomplete.", filePath);
+              return;
+          }
+          SetStatusText(wxString::Format("Exported %d tasks", exportedCount));
+          wxMessageBox(wxString::Format("Successfully exported %d tasks to %s", 
+                                      exportedCount, filePath), 
+                      "Export Complete", wxOK | wxICON_INFORMATION);
+      });
 }
 
 void MainFrame::OnImportTasks(wxCommandEvent& event) {
@@ -1586,130 +1588,36 @@ void MainFrame::OnImportTasks(wxCommandEvent& event) {
   
   wxString filePath = openFileDialog.GetPath();
 
-  wxFileInputStream input(filePath);
-  if (!input.IsOk()) {
-      wxLogError("Cannot open file '%s'.", filePath);
-      return;
-  }
-
-  wxTextInputStream text(input);
-
-  // Add this warning message before processing the CSV
-  wxMessageBox("Note: The CSV import has limitations with handling quoted fields containing commas. "
-              "Please ensure your CSV file uses simple formatting.",
-              "Import Notice", wxOK | wxICON_INFORMATION);
-  
-  // Skip header
-  if (!input.Eof()) {
-      wxString line = text.ReadLine();
+  // Progress is reported as a fraction of the file read
+  const int progressRange = 1000;
+  wxProgressDialog progressDlg("Import Tasks", "Importing tasks...", progressRange, this,
+                               wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+  
+  // The import runs its own transaction
+  dbManager->FlushWrites();
+  TaskImporter importer(dbManager, categoryManager, userManager->GetCurrentUser()->id);
+  ImportResult result = importer.ImportCsv(filePath,
+      [&progressDlg, progressRange](int rowsRead, wxFileOffset bytesRead, wxFileOffset totalBytes) {
+          int value = totalBytes > 0
+              ? static_cast<int>(bytesRead * (progressRange - 1) / totalBytes) : 0;
+          return progressDlg.Update(value, wxString::Format("Importing tasks... %d rows read", rowsRead));
+      });
+  progressDlg.Update(progressRange);
+  
+  if (!result.error.IsEmpty()) {
+      wxMessageBox(wxString::Format("Import failed and was rolled back: %s", result.error),
+                  "Import Error", wxOK | wxICON_ERROR);
+  } else if (result.cancelled) {
+      wxMessageBox("Import cancelled, no tasks were imported.",
+                  "Import Results", wxOK | wxICON_INFORMATION);
+  } else {
+      wxMessageBox(wxString::Format("Import complete. %d tasks imported, %d skipped.", 
+                                  result.imported, result.skipped), 
+                  "Import Results", wxOK | wxICON_INFORMATION);
   }
   
-  int successCount = 0;
-  int skipCount = 0;
-  
-  // Process each line
-  while (!input.Eof()) {
-      wxString line = text.ReadLine();
-      if (line.IsEmpty()) continue;
-      
-      // Parse CSV line
-      wxStringTokenizer tokenizer(line, ",", wxTOKEN_RET_EMPTY_ALL);
-      
-      // Skip ID field
-      if (!tokenizer.HasMoreTokens()) continue;
-      tokenizer.GetNextToken();
-      
-      // Title
-      if (!tokenizer.HasMoreTokens()) continue;
-      wxString title = tokenizer.GetNextToken();
-      // Remove quotes if present
-      if (title.StartsWith("\"") && title.EndsWith("\"")) {
-          title = title.SubString(1, title.Length() - 2);
-      }
-      title.Replace("\"\"", "\"");  // Unescape quotes
-      
-      // Description
-      if (!tokenizer.HasMoreTokens()) continue;
-      wxString description = tokenizer.GetNextToken();
-      // Remove quotes if present
-      if (description.StartsWith("\"") && description.EndsWith("\"")) {
-          description = description.SubString(1, description.Length() - 2);
-      }
-      description.Replace("\"\"", "\"");  // Unescape quotes
-      
-      // Due Date
-      if (!tokenizer.HasMoreTokens()) continue;
-      wxString dueDate = tokenizer.GetNextToken();
-      
-      // Priority
-      if (!tokenizer.HasMoreTokens()) continue;
-      wxString priorityStr = tokenizer.GetNextToken();
-      long priority;
-      if (!priorityStr.ToLong(&priority) || priority < 1 || priority > 5) {
-          priority = 1;
-      }
-      
-      // Category
-      if (!tokenizer.HasMoreTokens()) continue;
-      wxString categoryName = tokenizer.GetNextToken();
-      // Remove quotes if present
-      if (categoryName.StartsWith("\"") && categoryName.EndsWith("\"")) {
-          categoryName = categoryName.SubString(1, categoryName.Length() - 2);
-      }
-      categoryName.Replace("\"\"", "\"");  // Unescape quotes
-      
-      // Find category ID or create new category
-      int categoryId = -1;
-      if (categoryName != "No Category") {
-          bool found = false;
-          for (const auto& category : categories) {
-              if (category.name == categoryName) {
-                  categoryId = category.id;
-                  found = true;
-                  break;
-              }
-          }
-          
-          if (!found) {
-              // Create new category
-              wxColour randomColor(rand() % 200 + 55, rand() % 200 + 55, rand() % 200 + 55);
-              wxString colorStr = randomColor.GetAsString(wxC2S_HTML_SYNTAX);
-              
-              if (categoryManager->AddCategory(categoryName, colorStr, "", 
-                                            userManager->GetCurrentUser()->id)) {
-                  // Reload categories to get the new ID
-                  LoadCategories();
-                  for (const auto& category : categories) {
-                      if (category.name == categoryName) {
-                          categoryId = category.id;
-                          break;
-                      }
-                  }
-              }
-          }
-      }
-      
-      // Completed
-      if (!tokenizer.HasMoreTokens()) continue;
-      wxString completedStr = tokenizer.GetNextToken();
-      bool completed = (completedStr == "Yes" || completedStr == "yes" || 
-                       completedStr == "TRUE" || completedStr == "true" || 
-                       completedStr == "1");
-      
-      // Add task to database
-      if (dbManager->AddTask(title, description, dueDate, priority, categoryId, 
-                           userManager->GetCurrentUser()->id)) {
-          successCount++;
-      } else {
-          skipCount++;
-      }
-  }
-  
-  wxMessageBox(wxString::Format("Import complete. %d tasks imported, %d skipped.", 
-                              successCount, skipCount), 
-              "Import Results", wxOK | wxICON_INFORMATION);
-  
-  // Reload tasks
+  // Reload categories created by the import and tasks
+  LoadCategories();
   LoadTasks();
   UpdateDashboardStatistics();
 }
@@ -1719,6 +1627,7 @@ void MainFrame::OnLogout(wxCommandEvent& event) {
                            "Confirm Logout", wxYES_NO | wxNO_DEFAULT | wxICON_QUESTION);
   
   if (confirmDlg.ShowModal() == wxID_YES) {
+      dbManager->FlushWrites();
       userManager->Logout();
       
       // Close current frame and show login dialog
@@ -1748,6 +1657,8 @@ void MainFrame::OnProfile(wxCommandEvent& event) {
 }
 
 void MainFrame::OnManageCategories(wxCommandEvent& event) {
+  // Deleting a category rewrites its tasks
+  dbManager->FlushWrites();
   CategoryListDialog dlg(this, categoryManager, userManager);
   if (dlg.ShowModal() == wxID_OK) {
       // Reload categories and tasks (which may have updated category information)
@@ -1756,6 +1667,62 @@ void MainFrame::OnManageCategories(wxCommandEvent& event) {
   }
 }
 
+void MainFrame::OnRecordQueryStats(wxCommandEvent& event) {
+  // Statistics gathered so far are kept when recording stops
+  wxSQLite3Profiler* profiler = event.IsChecked() ? queryProfiler : nullptr;
+  dbManager->GetDatabase()->SetProfiler(profiler);
+  readerPool->SetProfiler(profiler);
+  SetStatusText(profiler != nullptr ? "Recording query statistics" : "Stopped recording query statistics");
+}
+
+void MainFrame::OnShowQueryStats(wxCommandEvent& event) {
+  wxDialog dlg(this, wxID_ANY, "Query Statistics", wxDefaultPosition, wxSize(900, 500),
+               wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
+  
+  // One line per statement, slowest in total first
+  wxTextCtrl* statsText = new wxTextCtrl(&dlg, wxID_ANY, queryProfiler->Format(), wxDefaultPosition,
+                                         wxDefaultSize, wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP | wxHSCROLL);
+  statsText->SetFont(wxFont(9, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+  
+  wxButton* resetButton = new wxButton(&dlg, wxID_ANY, "Reset");
+  wxButton* closeButton = new wxButton(&dlg, wxID_CANCEL, "Close");
+  resetButton->Bind(wxEVT_BUTTON, [this, statsText](wxCommandEvent&) {
+      queryProfiler->Reset();
+      statsText->SetValue(queryProfiler->Format());
+  });
+  
+  wxBoxSizer* buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+  buttonSizer->Add(resetButton, 0, wxRIGHT, 5);
+  buttonSizer->AddStretchSpacer();
+  buttonSizer->Add(closeButton, 0);
+  
+  wxBoxSizer* dlgSizer = new wxBoxSizer(wxVERTICAL);
+  dlgSizer->Add(statsText, 1, wxALL | wxEXPAND, 10);
+  dlgSizer->Add(buttonSizer, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, 10);
+  dlg.SetSizer(dlgSizer);
+  
+  dlg.ShowModal();
+}
+
+void MainFrame::OnSaveQueryStats(wxCommandEvent& event) {
+  wxFileDialog saveFileDialog(this, "Save Query Statistics", "", "query_stats.txt",
+                             "Text files (*.txt)|*.txt", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+  
+  if (saveFileDialog.ShowModal() == wxID_CANCEL) {
+      return;
+  }
+  
+  wxFileOutputStream output(saveFileDialog.GetPath());
+  if (!output.IsOk()) {
+      wxLogError("Cannot save to file '%s'.", saveFileDialog.GetPath());
+      return;
+  }
+  
+  wxTextOutputStream text(output);
+  text << queryProfiler->Format();
+  SetStatusText("Query statistics saved");
+}
+
 void MainFrame::OnExit(wxCommandEvent& event) {
   Close(true);
 }
@@ -1767,31 +1734,106 @@ void MainFrame::OnAbout(wxCommandEvent& event) {
 
 void MainFrame::OnSearchTasks(wxCommandEvent& event) {
   // Create a vector to store search results
-  std::vector<Task> searchResults;
+  // The dialog's results replace a live search
+  if (searcher) {
+      searcher->Cancel();
+  }
+  searchTimer.Stop();
+  searchBox->ChangeValue(wxEmptyString);
+  
+  TaskStore searchResults;
   
   // Show search dialog
   SearchDialog dlg(this, dbManager, categoryManager, userManager->GetCurrentUser()->id, &searchResults);
   
   if (dlg.ShowModal() == wxID_OK) {
       // Display search results
-      tasks = searchResults;
-      DisplayTasks();
+      size_t resultCount = searchResults.GetCount();
+      size_t completedCount = searchResults.CountCompleted();
+      DisplayTasks(std::unique_ptr<TaskRowSource>(new StoredTaskSource(std::move(searchResults))));
       
-      SetStatusText(wxString::Format("Search results: %zu tasks found", tasks.size()));
+      SetStatusText(wxString::Format("Search results: %zu tasks found, %zu completed", 
+                                    resultCount, completedCount));
   }
 }
 
 void MainFrame::OnToggleCompleted(wxCommandEvent& event) {
-  static bool includeCompleted = true;
-  
-  includeCompleted = !includeCompleted;
-  
-  tasks = dbManager->GetAllTasks(userManager->GetCurrentUser()->id, includeCompleted);
-  DisplayTasks();
+  taskFilter.includeCompleted = !taskFilter.includeCompleted;
+  LoadTasks();
   
-  SetStatusText(includeCompleted ? 
+  SetStatusText(taskFilter.includeCompleted ? 
               "Showing all tasks" : 
               "Showing only pending tasks");
 }
 
+void MainFrame::OnSearchText(wxCommandEvent& event) {
+  // Whatever is running is out of date now
+  if (searcher) {
+      searcher->Cancel();
+  }
+  
+  if (searchBox->GetValue().Trim().IsEmpty()) {
+      searchTimer.Stop();
+      LoadTasks();
+      SetStatusText(wxString::Format("Logged in as: %s", userManager->GetCurrentUser()->username));
+      return;
+  }
+  
+  searchTimer.StartOnce(SEARCH_DELAY_MS);
+}
+
+void MainFrame::OnSearchCancel(wxCommandEvent& event) {
+  // Clearing the box sends a text event, which restores the listing
+  searchBox->Clear();
+}
+
+void MainFrame::OnSearchTimer(wxTimerEvent& event) {
+  StartLiveSearch();
+}
+
+void MainFrame::StartLiveSearch() {
+  TaskSearch search;
+  search.text = searchBox->GetValue();
+  search.field = TaskSearch::ALL_FIELDS;
+  search.priority = 0;
+  search.fromDay = NO_DUE_DATE;
+  search.toDay = NO_DUE_DATE;
+  search.categoryId = -1;
+  search.includeCompleted = taskFilter.includeCompleted;
+  
+  int userId = userManager->GetCurrentUser()->id;
+  
+  if (!searcher) {
+      TaskStore results;
+      dbManager->SearchTasks(userId, search, results);
+      // A new generation, so the results replace the grid contents
+      OnLiveSearchResults(liveGeneration + 1, results, true);
+      return;
+  }
+  
+  searcher->Submit(userId, search);
+  SetStatusText("Searching...");
+}
+
+void MainFrame::OnLiveSearchResults(unsigned generation, TaskStore& batch, bool done) {
+  // Rows come from the search connection, which has no category cache
+  batch.ResolveCategories(*categoryManager);
+  
+  if (liveResults == nullptr || generation != liveGeneration) {
+      // First batch of a new search replaces the grid contents
+      auto source = std::make_unique<StoredTaskSource>(std::move(batch));
+      StoredTaskSource* results = source.get();
+      DisplayTasks(std::move(source));
+      liveResults = results;
+      liveGeneration = generation;
+  } else {
+      liveResults->Append(batch);
+      taskTable->SetSource(liveResults);
+  }
+  
+  if (done) {
+      SetStatusText(wxString::Format("Search results: %d tasks found", liveResults->GetCount()));
+  }
+}
+
 wxIMPLEMENT_APP(TaskManagerApp);
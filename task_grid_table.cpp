@@ -0,0 +1,475 @@
+#include "task_grid_table.h"
+#include <algorithm>
+
+namespace {
+
+// Position of key among the rows of a page
+int LowerBound(const TaskStore& tasks, const TaskKey& key) {
+    int low = 0;
+    int high = static_cast<int>(tasks.GetCount());
+    while (low < high) {
+        int mid = (low + high) / 2;
+        TaskKey rowKey{tasks.GetDueDay(mid), tasks.GetPriority(mid), tasks.GetId(mid)};
+        if (rowKey < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+} // namespace
+
+// TaskRowSource implementation
+bool TaskRowSource::GetTask(int row, Task& task) {
+    size_t index;
+    const TaskStore* store = GetRow(row, index);
+    if (store == nullptr) {
+        return false;
+    }
+    store->GetTask(index, task);
+    return true;
+}
+
+void TaskRowSource::ApplyChanges(const std::vector<TaskChange>& changes, std::vector<TaskRowEdit>& edits) {
+    for (const TaskChange& change : changes) {
+        ApplyChange(change, edits);
+    }
+}
+
+// StoredTaskSource implementation
+const TaskStore* StoredTaskSource::GetRow(int row, size_t& index) {
+    if (row < 0 || row >= static_cast<int>(tasks.GetCount())) {
+        return nullptr;
+    }
+    index = row;
+    return &tasks;
+}
+
+void StoredTaskSource::ApplyChange(const TaskChange& change, std::vector<TaskRowEdit>& edits) {
+    if (!change.hasBefore) {
+        return;
+    }
+
+    int row = tasks.FindRow(change.before.id);
+    if (row < 0) {
+        return;
+    }
+
+    if (change.hasAfter) {
+        tasks.Replace(row, change.after);
+    } else {
+        tasks.Erase(row);
+        edits.push_back(TaskRowEdit{TaskRowEdit::DELETED, row});
+    }
+}
+
+// PagedTaskSource implementation
+PagedTaskSource::PagedTaskSource(DatabaseManager* dbManager, int userId, const TaskFilter& filter,
+                                 int pageSize, size_t maxPages)
+    : dbManager(dbManager), userId(userId), filter(filter),
+      pageSize(pageSize > 0 ? pageSize : DEFAULT_PAGE_SIZE),
+      maxPages(maxPages > 0 ? maxPages : 1), knownRows(0), batching(false) {
+    count = dbManager->CountTasks(userId, filter);
+}
+
+const TaskStore* PagedTaskSource::GetRow(int row, size_t& index) {
+    if (row < 0 || row >= count) {
+        return nullptr;
+    }
+
+    int offset;
+    const Page* page = GetPage(FindPage(row, offset));
+    if (page == nullptr || offset >= static_cast<int>(page->tasks.GetCount())) {
+        return nullptr;
+    }
+    index = offset;
+    return &page->tasks;
+}
+
+int PagedTaskSource::FindPage(int row, int& offset) const {
+    if (row >= knownRows) {
+        offset = (row - knownRows) % pageSize;
+        return static_cast<int>(pageEnds.size()) + (row - knownRows) / pageSize;
+    }
+
+    // The last page starting at or before row; pages emptied by deletes
+    // share their start with the next page and are skipped
+    int index = static_cast<int>(std::upper_bound(pageStarts.begin(), pageStarts.end(), row) -
+                                 pageStarts.begin()) - 1;
+    offset = row - pageStarts[index];
+    return index;
+}
+
+int PagedTaskSource::FindKeyPage(const TaskKey& key) const {
+    auto found = std::lower_bound(pageEnds.begin(), pageEnds.end(), key);
+    return found != pageEnds.end() ? static_cast<int>(found - pageEnds.begin()) : -1;
+}
+
+bool PagedTaskSource::FindPageEnd(int index) {
+    // Walk forward from the last known page end, reading keys only
+    while (static_cast<int>(pageEnds.size()) <= index) {
+        const TaskKey* after = pageEnds.empty() ? nullptr : &pageEnds.back();
+        TaskKey key;
+        if (!dbManager->GetTaskKeyAt(userId, filter, after, pageSize - 1, key)) {
+            return false;
+        }
+        AddPageEnd(key);
+    }
+    return true;
+}
+
+void PagedTaskSource::AddPageEnd(const TaskKey& key) {
+    pageEnds.push_back(key);
+    pageStarts.push_back(knownRows);
+    pageCounts.push_back(pageSize);
+    knownRows += pageSize;
+}
+
+PagedTaskSource::Page* PagedTaskSource::GetPage(int index) {
+    auto found = pageIndex.find(index);
+    if (found != pageIndex.end()) {
+        pages.splice(pages.begin(), pages, found->second);
+        return &pages.front();
+    }
+
+    if (index > 0 && !FindPageEnd(index - 1)) {
+        return nullptr;
+    }
+
+    bool known = index < static_cast<int>(pageEnds.size());
+    Page page;
+    page.index = index;
+    TaskPage result;
+    if (!dbManager->GetTasksPage(userId, filter, index > 0 ? &pageEnds[index - 1] : nullptr,
+                                 known ? pageCounts[index] : pageSize, result)) {
+        return nullptr;
+    }
+    page.tasks = std::move(result.tasks);
+
+    if (!known && static_cast<int>(page.tasks.GetCount()) == pageSize) {
+        AddPageEnd(result.lastKey);
+    }
+
+    while (pages.size() >= maxPages) {
+        pageIndex.erase(pages.back().index);
+        pages.pop_back();
+    }
+
+    pages.push_front(std::move(page));
+    pageIndex[index] = pages.begin();
+    return &pages.front();
+}
+
+PagedTaskSource::Page* PagedTaskSource::FindLoadedPage(int index) {
+    auto found = pageIndex.find(index);
+    return found != pageIndex.end() ? &*found->second : nullptr;
+}
+
+void PagedTaskSource::ResizePage(int index, int delta) {
+    pageCounts[index] += delta;
+    for (size_t next = index + 1; next < pageStarts.size(); ++next) {
+        pageStarts[next] += delta;
+    }
+    knownRows += delta;
+    count += delta;
+}
+
+void PagedTaskSource::DropPagesPastEnds() {
+    // Such a page is the partial last one, and its rows are about to move
+    for (auto it = pages.begin(); it != pages.end();) {
+        if (it->index >= static_cast<int>(pageEnds.size())) {
+            pageIndex.erase(it->index);
+            it = pages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool PagedTaskSource::Includes(const Task& task) const {
+    return task.userId == userId && (filter.includeCompleted || !task.completed);
+}
+
+void PagedTaskSource::InsertRow(const Task& task, std::vector<TaskRowEdit>& edits) {
+    TaskKey key = TaskKey::Of(task);
+    int index = FindKeyPage(key);
+    if (index < 0) {
+        ++count;
+        DropPagesPastEnds();
+        edits.push_back(TaskRowEdit{TaskRowEdit::INSERTED, knownRows});
+        return;
+    }
+
+    // The database already has the row, so a page read after resizing
+    // includes it
+    ResizePage(index, 1);
+    int offset = 0;
+    if (Page* page = FindLoadedPage(index)) {
+        offset = LowerBound(page->tasks, key);
+        page->tasks.Insert(offset, task);
+    } else if (batching) {
+        offset = 0;
+    } else if (Page* page = GetPage(index)) {
+        offset = std::max(page->tasks.FindRow(task.id), 0);
+    }
+    edits.push_back(TaskRowEdit{TaskRowEdit::INSERTED, pageStarts[index] + offset});
+}
+
+void PagedTaskSource::RemoveRow(const Task& task, std::vector<TaskRowEdit>& edits) {
+    TaskKey key = TaskKey::Of(task);
+    int index = FindKeyPage(key);
+    if (index < 0) {
+        --count;
+        DropPagesPastEnds();
+        edits.push_back(TaskRowEdit{TaskRowEdit::DELETED, knownRows});
+        return;
+    }
+
+    ResizePage(index, -1);
+    int offset = 0;
+    if (Page* page = FindLoadedPage(index)) {
+        offset = LowerBound(page->tasks, key);
+        if (offset < static_cast<int>(page->tasks.GetCount()) && page->tasks.GetId(offset) == task.id) {
+            page->tasks.Erase(offset);
+        }
+    } else if (batching) {
+        offset = 0;
+    } else if (Page* page = GetPage(index)) {
+        offset = LowerBound(page->tasks, key);
+    }
+    edits.push_back(TaskRowEdit{TaskRowEdit::DELETED, pageStarts[index] + offset});
+}
+
+void PagedTaskSource::UpdateRow(const Task& task) {
+    int index = FindKeyPage(TaskKey::Of(task));
+    if (index < 0) {
+        DropPagesPastEnds();
+        return;
+    }
+
+    Page* page = FindLoadedPage(index);
+    if (page != nullptr) {
+        int row = page->tasks.FindRow(task.id);
+        if (row >= 0) {
+            page->tasks.Replace(row, task);
+        }
+    }
+}
+
+void PagedTaskSource::ApplyChanges(const std::vector<TaskChange>& changes,
+                                   std::vector<TaskRowEdit>& edits) {
+    batching = true;
+    TaskRowSource::ApplyChanges(changes, edits);
+    batching = false;
+}
+
+void PagedTaskSource::ApplyChange(const TaskChange& change, std::vector<TaskRowEdit>& edits) {
+    bool removed = change.hasBefore && Includes(change.before);
+    bool added = change.hasAfter && Includes(change.after);
+
+    if (removed && added && TaskKey::Of(change.before) == TaskKey::Of(change.after)) {
+        UpdateRow(change.after);
+        return;
+    }
+    if (removed) {
+        RemoveRow(change.before, edits);
+    }
+    if (added) {
+        InsertRow(change.after, edits);
+    }
+}
+
+// TaskGridTable implementation
+TaskGridTable::TaskGridTable() : source(nullptr), reportedRows(0) {
+}
+
+int TaskGridTable::GetNumberRows() {
+    return source != nullptr ? source->GetCount() : 0;
+}
+
+bool TaskGridTable::IsEmptyCell(int row, int col) {
+    size_t index;
+    return GetRow(row, index) == nullptr;
+}
+
+wxString TaskGridTable::GetValue(int row, int col) {
+    size_t index;
+    const TaskStore* tasks = GetRow(row, index);
+    if (tasks == nullptr) {
+        return wxEmptyString;
+    }
+
+    switch (col) {
+        case COL_ID:        return wxString::Format("%d", tasks->GetId(index));
+        case COL_TITLE:     return tasks->GetTitle(index);
+        case COL_DUE_DATE:  return FormatDueDay(tasks->GetDueDay(index));
+        case COL_PRIORITY:  return wxString::Format("%d", tasks->GetPriority(index));
+        case COL_CATEGORY:  return tasks->GetCategory(index)->name;
+        case COL_COMPLETED: return tasks->IsCompleted(index) ? "Yes" : "No";
+        default:            return wxEmptyString;
+    }
+}
+
+void TaskGridTable::SetValue(int row, int col, const wxString& value) {
+    // Tasks are edited through the form below the grid
+}
+
+wxString TaskGridTable::GetColLabelValue(int col) {
+    switch (col) {
+        case COL_ID:        return "ID";
+        case COL_TITLE:     return "Title";
+        case COL_DUE_DATE:  return "Due Date";
+        case COL_PRIORITY:  return "Priority";
+        case COL_CATEGORY:  return "Category";
+        case COL_COMPLETED: return "Completed";
+        default:            return wxEmptyString;
+    }
+}
+
+const TaskStore* TaskGridTable::GetRow(int row, size_t& index) const {
+    return source != nullptr ? source->GetRow(row, index) : nullptr;
+}
+
+bool TaskGridTable::GetTask(int row, Task& task) const {
+    return source != nullptr && source->GetTask(row, task);
+}
+
+void TaskGridTable::SetSource(TaskRowSource* newSource) {
+    source = newSource;
+
+    wxGrid* grid = GetView();
+    int rows = GetNumberRows();
+
+    if (grid != nullptr) {
+        if (rows > reportedRows) {
+            wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_APPENDED, rows - reportedRows);
+            grid->ProcessTableMessage(msg);
+        } else if (rows < reportedRows) {
+            wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_DELETED, rows, reportedRows - rows);
+            grid->ProcessTableMessage(msg);
+        }
+        grid->ForceRefresh();
+    }
+
+    reportedRows = rows;
+}
+
+void TaskGridTable::ApplyChange(const TaskChange& change) {
+    if (source == nullptr) {
+        return;
+    }
+
+    std::vector<TaskRowEdit> edits;
+    source->ApplyChange(change, edits);
+    NotifyRowEdits(edits);
+}
+
+void TaskGridTable::ApplyChanges(const std::vector<TaskChange>& changes) {
+    if (source == nullptr) {
+        return;
+    }
+
+    std::vector<TaskRowEdit> edits;
+    source->ApplyChanges(changes, edits);
+    NotifyRowEdits(edits);
+}
+
+void TaskGridTable::NotifyRowEdits(const std::vector<TaskRowEdit>& edits) {
+    wxGrid* grid = GetView();
+    size_t i = 0;
+    while (i < edits.size()) {
+        const TaskRowEdit& first = edits[i];
+        int count = 1;
+        for (++i; i < edits.size() && edits[i].kind == first.kind; ++i) {
+            int next = first.kind == TaskRowEdit::INSERTED ? first.row + count : first.row;
+            if (edits[i].row != next) {
+                break;
+            }
+            ++count;
+        }
+
+        if (first.kind == TaskRowEdit::INSERTED) {
+            reportedRows += count;
+            if (grid != nullptr) {
+                wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_INSERTED, first.row, count);
+                grid->ProcessTableMessage(msg);
+            }
+        } else {
+            reportedRows -= count;
+            if (grid != nullptr) {
+                wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_DELETED, first.row, count);
+                grid->ProcessTableMessage(msg);
+            }
+        }
+    }
+
+    if (grid != nullptr) {
+        grid->ForceRefresh();
+    }
+}
+
+// TaskGridAttrProvider implementation
+TaskGridAttrProvider::TaskGridAttrProvider(const TaskGridTable* table)
+    : table(table) {
+    completedAttr = new wxGridCellAttr();
+    completedAttr->SetBackgroundColour(wxColour(240, 240, 240));
+
+    highPriorityAttr = new wxGridCellAttr();
+    highPriorityAttr->SetBackgroundColour(wxColour(255, 200, 200));
+}
+
+TaskGridAttrProvider::~TaskGridAttrProvider() {
+    completedAttr->DecRef();
+    highPriorityAttr->DecRef();
+    for (auto& entry : categoryAttrs) {
+        entry.second->DecRef();
+    }
+}
+
+wxGridCellAttr* TaskGridAttrProvider::GetCategoryAttr(const CategoryInfo& category) const {
+    auto it = categoryAttrs.find(category.rgb);
+    if (it != categoryAttrs.end()) {
+        return it->second;
+    }
+
+    wxGridCellAttr* attr = new wxGridCellAttr();
+    attr->SetBackgroundColour(wxColour((category.rgb >> 16) & 0xFF, (category.rgb >> 8) & 0xFF,
+                                       category.rgb & 0xFF));
+    attr->SetTextColour(category.darkText ? *wxBLACK : *wxWHITE);
+
+    categoryAttrs.emplace(category.rgb, attr);
+    return attr;
+}
+
+wxGridCellAttr* TaskGridAttrProvider::GetAttr(int row, int col, wxGridCellAttr::wxAttrKind kind) const {
+    size_t index;
+    const TaskStore* tasks = table->GetRow(row, index);
+    if (tasks == nullptr) {
+        return nullptr;
+    }
+
+    wxGridCellAttr* attr = nullptr;
+
+    if (col == TaskGridTable::COL_CATEGORY) {
+        CategoryInfoPtr category = tasks->GetCategory(index);
+        if (category->hasColor) {
+            attr = GetCategoryAttr(*category);
+        }
+    }
+
+    if (attr == nullptr) {
+        if (tasks->IsCompleted(index)) {
+            attr = completedAttr;
+        } else if (col == TaskGridTable::COL_PRIORITY && tasks->GetPriority(index) >= 4) {
+            attr = highPriorityAttr;
+        }
+    }
+
+    // The grid releases the attribute it is given
+    if (attr != nullptr) {
+        attr->IncRef();
+    }
+    return attr;
+}
@@ -0,0 +1,192 @@
+#ifndef TASK_GRID_TABLE_H
+#define TASK_GRID_TABLE_H
+
+#include <wx/wx.h>
+#include <wx/grid.h>
+#include "database_manager.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// A row inserted into or deleted from a TaskRowSource by a task change
+struct TaskRowEdit {
+    enum Kind { INSERTED, DELETED };
+
+    Kind kind;
+    int row;    // Position when the edit was made
+};
+
+// Rows shown by the tasks grid
+class TaskRowSource {
+public:
+    virtual ~TaskRowSource() {}
+
+    virtual int GetCount() = 0;
+    // Store holding a row and the row's index in it, or nullptr when the
+    // row is out of range or cannot be loaded. The pointer is only valid
+    // until the next call.
+    virtual const TaskStore* GetRow(int row, size_t& index) = 0;
+
+    // Applies a change made by DatabaseManager to the rows it touches,
+    // without reloading the others, and appends the rows inserted and
+    // deleted, in order. Rows edited in place only need a redraw.
+    virtual void ApplyChange(const TaskChange& change, std::vector<TaskRowEdit>& edits) = 0;
+    // The same for changes committed together, e.g. by a batch edit
+    virtual void ApplyChanges(const std::vector<TaskChange>& changes, std::vector<TaskRowEdit>& edits);
+
+    // Copies a row, without its description; false if GetRow fails
+    bool GetTask(int row, Task& task);
+};
+
+// Rows held in memory, e.g. search results
+class StoredTaskSource : public TaskRowSource {
+public:
+    explicit StoredTaskSource(TaskStore tasks) : tasks(std::move(tasks)) {}
+
+    // Adds rows at the end, e.g. a search's later batches; tell the table
+    // with TaskGridTable::SetSource
+    void Append(const TaskStore& rows) { tasks.Append(rows); }
+    const TaskStore& GetTasks() const { return tasks; }
+
+    int GetCount() override { return static_cast<int>(tasks.GetCount()); }
+    const TaskStore* GetRow(int row, size_t& index) override;
+    // The rows are not re-queried: an edited task keeps its place and a
+    // deleted one is removed, while new tasks wait for the next search
+    void ApplyChange(const TaskChange& change, std::vector<TaskRowEdit>& edits) override;
+
+private:
+    TaskStore tasks;
+};
+
+// Rows of a user's task listing, fetched a page at a time with keyset
+// pagination as the grid asks for them. At most maxPages pages are kept;
+// the least recently used page is dropped first. Besides the pages, only
+// the key ending each page visited so far is remembered, so that jumping
+// back to a page is a single indexed query.
+//
+// A task change is placed by its key: it goes into the visited page whose
+// end key follows it, which is patched in memory or, when not kept, read
+// again, and only the row counts of later pages move. Past the visited
+// pages nothing is kept, so there only the row count changes.
+class PagedTaskSource : public TaskRowSource {
+public:
+    static const int DEFAULT_PAGE_SIZE = 200;
+    static const size_t DEFAULT_MAX_PAGES = 8;
+
+    PagedTaskSource(DatabaseManager* dbManager, int userId, const TaskFilter& filter,
+                    int pageSize = DEFAULT_PAGE_SIZE, size_t maxPages = DEFAULT_MAX_PAGES);
+
+    int GetCount() override { return count; }
+    const TaskStore* GetRow(int row, size_t& index) override;
+    void ApplyChange(const TaskChange& change, std::vector<TaskRowEdit>& edits) override;
+    // The database is already past the changes not yet applied, so pages
+    // are not read meanwhile: a row in a page that is not kept is placed
+    // at the start of the page
+    void ApplyChanges(const std::vector<TaskChange>& changes, std::vector<TaskRowEdit>& edits) override;
+
+private:
+    struct Page {
+        int index;
+        TaskStore tasks;
+    };
+    typedef std::list<Page> PageList;
+
+    DatabaseManager* dbManager;
+    int userId;
+    TaskFilter filter;
+    int pageSize;
+    size_t maxPages;
+    int count;
+
+    PageList pages; // Most recently used first
+    std::unordered_map<int, PageList::iterator> pageIndex;
+    // Pages with a known end key, from the top of the listing. Edits
+    // change their row counts; pages past them hold pageSize rows.
+    std::vector<TaskKey> pageEnds; // Key ending page 0, 1, ...
+    std::vector<int> pageStarts;   // First row of each page
+    std::vector<int> pageCounts;   // Rows in each page
+    int knownRows;                 // Rows in the pages above
+    bool batching;                 // In ApplyChanges
+
+    Page* GetPage(int index);
+    Page* FindLoadedPage(int index);
+    bool FindPageEnd(int index);
+    void AddPageEnd(const TaskKey& key);
+    int FindPage(int row, int& offset) const;
+    int FindKeyPage(const TaskKey& key) const;
+    void ResizePage(int index, int delta);
+    void DropPagesPastEnds();
+
+    bool Includes(const Task& task) const;
+    void InsertRow(const Task& task, std::vector<TaskRowEdit>& edits);
+    void RemoveRow(const Task& task, std::vector<TaskRowEdit>& edits);
+    void UpdateRow(const Task& task);
+};
+
+// Read-only grid model over a TaskRowSource. Cells are formatted straight
+// from the store's columns when the grid draws them, so refreshing the
+// grid costs the same for ten tasks as for ten thousand.
+class TaskGridTable : public wxGridTableBase {
+public:
+    enum Column {
+        COL_ID,
+        COL_TITLE,
+        COL_DUE_DATE,
+        COL_PRIORITY,
+        COL_CATEGORY,
+        COL_COMPLETED,
+        COL_COUNT
+    };
+
+    TaskGridTable();
+
+    int GetNumberRows() override;
+    int GetNumberCols() override { return COL_COUNT; }
+    bool IsEmptyCell(int row, int col) override;
+    wxString GetValue(int row, int col) override;
+    void SetValue(int row, int col, const wxString& value) override;
+    wxString GetColLabelValue(int col) override;
+
+    // See TaskRowSource::GetRow and TaskRowSource::GetTask
+    const TaskStore* GetRow(int row, size_t& index) const;
+    bool GetTask(int row, Task& task) const;
+
+    // Shows the rows of source, which the caller keeps alive, and tells
+    // the grid about the new row count
+    void SetSource(TaskRowSource* source);
+    // Passes a task change to the source and tells the grid which rows
+    // were inserted or deleted, so that only those move
+    void ApplyChange(const TaskChange& change);
+    // The same for the changes of a batch edit, with one refresh
+    void ApplyChanges(const std::vector<TaskChange>& changes);
+
+private:
+    TaskRowSource* source;
+    int reportedRows; // Row count the grid currently knows about
+
+    // Sends the grid the row edits made by the source, merging runs of
+    // rows deleted at one position or inserted one after another
+    void NotifyRowEdits(const std::vector<TaskRowEdit>& edits);
+};
+
+// Computes cell colours from the task in each row: category colour with
+// readable text, grey for completed tasks and red for urgent priorities.
+// One attribute object is kept per distinct look and shared by all cells.
+class TaskGridAttrProvider : public wxGridCellAttrProvider {
+public:
+    explicit TaskGridAttrProvider(const TaskGridTable* table);
+    ~TaskGridAttrProvider() override;
+
+    wxGridCellAttr* GetAttr(int row, int col, wxGridCellAttr::wxAttrKind kind) const override;
+
+private:
+    const TaskGridTable* table;
+    wxGridCellAttr* completedAttr;
+    wxGridCellAttr* highPriorityAttr;
+    // Keyed by the category's colour as 0xRRGGBB
+    mutable std::unordered_map<wxUint32, wxGridCellAttr*> categoryAttrs;
+
+    wxGridCellAttr* GetCategoryAttr(const CategoryInfo& category) const;
+};
+
+#endif // TASK_GRID_TABLE_H
@@ -0,0 +1,157 @@
+#include "task_importer.h"
+#include "csv_reader.h"
+#include <wx/wfstream.h>
+#include <cstdlib>
+#include <iostream>
+
+TaskImporter::TaskImporter(DatabaseManager* dbManager, CategoryManager* categoryManager, int userId)
+    : dbManager(dbManager), categoryManager(categoryManager), userId(userId),
+      chunkSize(0), progressInterval(500) {
+}
+
+bool TaskImporter::ParseRecord(const CsvReader& reader, Row& row) {
+    if (reader.IsMalformed() || reader.GetFieldCount() < 7) {
+        return false;
+    }
+
+    // Field 0 is the exported ID, which is not reused
+    row.title = reader.GetFieldAsString(1);
+    row.description = reader.GetFieldAsString(2);
+    if (!ParseDueDay(reader.GetFieldAsString(3), row.dueDay)) {
+        row.dueDay = NO_DUE_DATE;
+    }
+
+    if (!reader.GetFieldAsString(4).ToLong(&row.priority) || row.priority < 1 || row.priority > 5) {
+        row.priority = 1;
+    }
+
+    row.categoryName = reader.GetFieldAsString(5);
+
+    std::string_view completed = reader.GetField(6);
+    row.completed = (completed == "Yes" || completed == "yes" ||
+                     completed == "TRUE" || completed == "true" ||
+                     completed == "1");
+
+    return !row.title.IsEmpty();
+}
+
+int TaskImporter::ResolveCategory(const wxString& categoryName) {
+    if (categoryName.IsEmpty() || categoryName == "No Category") {
+        return -1;
+    }
+
+    int categoryId = categoryManager->FindCategoryId(categoryName, userId);
+    if (categoryId > 0) {
+        return categoryId;
+    }
+
+    // Create new category; AddCategory adds it to the name index
+    wxColour randomColor(rand() % 200 + 55, rand() % 200 + 55, rand() % 200 + 55);
+    wxString colorStr = randomColor.GetAsString(wxC2S_HTML_SYNTAX);
+
+    return categoryManager->AddCategory(categoryName, colorStr, "", userId);
+}
+
+ImportResult TaskImporter::ImportCsv(const wxString& filePath, const ProgressCallback& progress) {
+    ImportResult result = { 0, 0, false, wxEmptyString };
+
+    wxFileInputStream input(filePath);
+    if (!input.IsOk()) {
+        result.error = wxString::Format("Cannot open file '%s'.", filePath);
+        return result;
+    }
+
+    wxFileOffset totalBytes = input.GetLength();
+    CsvReader reader(input);
+
+    // Skip header
+    reader.NextRecord();
+
+    wxSQLite3Database* db = dbManager->GetDatabase();
+
+    int rowsRead = 0;
+    int pending = 0; // Rows inserted in the open transaction
+    bool inTransaction = false;
+
+    try {
+        wxSQLite3Statement insert = db->PrepareStatement(
+            "INSERT INTO tasks (title, description, due_day, priority, completed, category_id, user_id) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?)"
+        );
+
+        db->ExecuteUpdate("BEGIN TRANSACTION");
+        inTransaction = true;
+
+        while (reader.NextRecord()) {
+            if (reader.IsBlankRecord()) continue;
+
+            rowsRead++;
+
+            Row row;
+            if (!ParseRecord(reader, row)) {
+                result.skipped++;
+            } else {
+                int categoryId = ResolveCategory(row.categoryName);
+
+                insert.Bind(1, row.title);
+                insert.Bind(2, row.description);
+                if (row.dueDay != NO_DUE_DATE) {
+                    insert.Bind(3, row.dueDay);
+                } else {
+                    insert.BindNull(3);
+                }
+                insert.Bind(4, static_cast<int>(row.priority));
+                insert.Bind(5, row.completed ? 1 : 0);
+
+                if (categoryId > 0) {
+                    insert.Bind(6, categoryId);
+                } else {
+                    insert.BindNull(6);
+                }
+
+                insert.Bind(7, userId);
+                insert.ExecuteUpdate();
+                pending++;
+
+                if (chunkSize > 0 && pending >= chunkSize) {
+                    db->ExecuteUpdate("COMMIT");
+                    result.imported += pending;
+                    pending = 0;
+                    db->ExecuteUpdate("BEGIN TRANSACTION");
+                }
+            }
+
+            if (progress && rowsRead % progressInterval == 0 &&
+                !progress(rowsRead, reader.GetBytesRead(), totalBytes)) {
+                result.cancelled = true;
+                break;
+            }
+        }
+
+        inTransaction = false;
+        if (result.cancelled) {
+            db->ExecuteUpdate("ROLLBACK");
+            // Categories created in the rolled back transaction are gone
+            categoryManager->InvalidateCaches();
+        } else {
+            db->ExecuteUpdate("COMMIT");
+            result.imported += pending;
+        }
+    }
+    catch (wxSQLite3Exception& e) {
+        std::cerr << "Import error: " << e.GetMessage().ToStdString() << std::endl;
+        result.error = e.GetMessage();
+
+        if (inTransaction) {
+            try {
+                db->ExecuteUpdate("ROLLBACK");
+            }
+            catch (wxSQLite3Exception&) {
+                // SQLite already rolled back on its own
+            }
+            categoryManager->InvalidateCaches();
+        }
+    }
+
+    return result;
+}
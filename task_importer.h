@@ -0,0 +1,62 @@
+#ifndef TASK_IMPORTER_H
+#define TASK_IMPORTER_H
+
+#include <wx/wx.h>
+#include <wx/stream.h>
+#include "database_manager.h"
+#include "category_manager.h"
+#include "csv_reader.h"
+#include <functional>
+
+// Outcome of an import run
+struct ImportResult {
+    int imported;       // Rows committed to the database
+    int skipped;        // Malformed rows that were ignored
+    bool cancelled;     // Stopped by the progress callback
+    wxString error;     // Database error that aborted the import, if any
+};
+
+// Imports tasks from a CSV file in the format written by "Export Tasks"
+// (ID, Title, Description, Due Date, Priority, Category, Completed).
+// Fields may be quoted and contain commas, quotes and line breaks.
+//
+// All rows go through one reused INSERT statement inside a single
+// transaction, or one transaction per chunk when a chunk size is set.
+// On a database error or cancellation the open transaction is rolled
+// back; with a chunk size, chunks committed before that point are kept.
+class TaskImporter {
+public:
+    // Receives the number of rows read so far and the file position;
+    // returning false cancels the import
+    typedef std::function<bool(int rowsRead, wxFileOffset bytesRead, wxFileOffset totalBytes)> ProgressCallback;
+
+    TaskImporter(DatabaseManager* dbManager, CategoryManager* categoryManager, int userId);
+
+    // Rows per transaction; 0 (the default) imports the whole file in one
+    void SetChunkSize(int rows) { chunkSize = rows; }
+    // Rows between progress callbacks
+    void SetProgressInterval(int rows) { progressInterval = rows > 0 ? rows : 1; }
+
+    ImportResult ImportCsv(const wxString& filePath, const ProgressCallback& progress = ProgressCallback());
+
+private:
+    struct Row {
+        wxString title;
+        wxString description;
+        int dueDay;
+        long priority;
+        wxString categoryName;
+        bool completed;
+    };
+
+    DatabaseManager* dbManager;
+    CategoryManager* categoryManager;
+    int userId;
+    int chunkSize;
+    int progressInterval;
+
+    static bool ParseRecord(const CsvReader& reader, Row& row);
+    int ResolveCategory(const wxString& categoryName);
+};
+
+#endif // TASK_IMPORTER_H
@@ -0,0 +1,124 @@
+#include "task_searcher.h"
+#include <memory>
+
+TaskSearcher::TaskSearcher(wxEvtHandler* owner, ConnectionPool* pool, const ResultCallback& onResults)
+    : owner(owner), pool(pool), onResults(onResults),
+      hasPending(false), running(nullptr), stopping(false), generation(0) {
+}
+
+TaskSearcher::~TaskSearcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        Supersede();
+    }
+    wakeUp.notify_one();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool TaskSearcher::Start() {
+    if (pool->GetReaderCount() == 0) {
+        return false;
+    }
+
+    worker = std::thread(&TaskSearcher::Run, this);
+    return true;
+}
+
+unsigned TaskSearcher::Submit(int userId, const TaskSearch& search) {
+    unsigned searchGeneration;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Supersede();
+        searchGeneration = generation;
+
+        pending.generation = searchGeneration;
+        pending.userId = userId;
+        pending.search = search;
+        hasPending = true;
+    }
+    wakeUp.notify_one();
+    return searchGeneration;
+}
+
+void TaskSearcher::Cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Supersede();
+    hasPending = false;
+}
+
+void TaskSearcher::Supersede() {
+    // Called with the mutex held. The worker sets and clears running under
+    // the same mutex, so the interrupt can only hit the search being
+    // superseded and not the reader's next borrower.
+    ++generation;
+    if (running != nullptr) {
+        running->GetDatabase()->Interrupt();
+    }
+}
+
+void TaskSearcher::Run() {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this] { return stopping || hasPending; });
+            if (stopping) {
+                return;
+            }
+
+            request = pending;
+            hasPending = false;
+        }
+
+        // Waiting for a reader may take a while; a search superseded
+        // meanwhile is dropped before it starts
+        ConnectionPool::Reader reader = pool->AcquireReader();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (generation != request.generation) {
+                continue;
+            }
+            running = &*reader;
+        }
+
+        TaskStore rows;
+        bool completed = reader->SearchTasks(request.userId, request.search, rows,
+            [this, &request](TaskStore& batch) {
+                if (generation != request.generation) {
+                    return false;
+                }
+                Deliver(request.generation, batch, false);
+                return true;
+            },
+            BATCH_SIZE);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = nullptr;
+        }
+
+        // A failed search still ends, with no further rows
+        if (!completed) {
+            rows.Clear();
+        }
+        Deliver(request.generation, rows, true);
+    }
+}
+
+void TaskSearcher::Deliver(unsigned searchGeneration, TaskStore& batch, bool done) {
+    if (generation != searchGeneration) {
+        return;
+    }
+
+    // CallAfter copies its functor, so the rows travel in a shared store
+    auto rows = std::make_shared<TaskStore>(std::move(batch));
+    owner->CallAfter([this, searchGeneration, rows, done] {
+        if (generation == searchGeneration) {
+            onResults(searchGeneration, *rows, done);
+        }
+    });
+}
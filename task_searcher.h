@@ -0,0 +1,68 @@
+#ifndef TASK_SEARCHER_H
+#define TASK_SEARCHER_H
+
+#include <wx/wx.h>
+#include "connection_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs task searches on a worker thread, each on a reader borrowed from
+// the pool, so that typing in the search box never waits for a query.
+//
+// Only the newest search matters: Submit replaces a request that has not
+// started yet and interrupts the query in progress. Rows are delivered in
+// batches on the UI thread through owner->CallAfter as they are read;
+// batches of a superseded or cancelled search are dropped before they
+// reach the callback.
+class TaskSearcher {
+public:
+    static const size_t BATCH_SIZE = 200;
+
+    // Receives the rows of one search in order; done is set on the last
+    // batch, which may be empty. The callback may move from batch.
+    typedef std::function<void(unsigned generation, TaskStore& batch, bool done)> ResultCallback;
+
+    TaskSearcher(wxEvtHandler* owner, ConnectionPool* pool, const ResultCallback& onResults);
+    ~TaskSearcher();
+
+    // Starts the thread; call once, on the UI thread. Fails when the pool
+    // has no readers.
+    bool Start();
+
+    // Starts a search and cancels the previous one; returns the search's
+    // generation, which its result batches carry
+    unsigned Submit(int userId, const TaskSearch& search);
+    // Cancels the running and pending searches
+    void Cancel();
+
+private:
+    struct Request {
+        unsigned generation;
+        int userId;
+        TaskSearch search;
+    };
+
+    wxEvtHandler* owner;
+    ConnectionPool* pool;
+    ResultCallback onResults;
+    std::thread worker;
+
+    std::mutex mutex;               // Guards the members below
+    std::condition_variable wakeUp;
+    Request pending;
+    bool hasPending;
+    DatabaseManager* running;       // Reader of the search in progress
+    bool stopping;
+
+    // Generation of the newest search; incremented by Submit and Cancel
+    std::atomic<unsigned> generation;
+
+    void Run();
+    void Supersede();
+    void Deliver(unsigned searchGeneration, TaskStore& batch, bool done);
+};
+
+#endif // TASK_SEARCHER_H
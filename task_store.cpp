@@ -0,0 +1,136 @@
+#include "task_store.h"
+#include "database_manager.h"
+#include <algorithm>
+
+void TaskStore::Clear() {
+    ids.clear();
+    dueDays.clear();
+    priorities.clear();
+    completed.clear();
+    categoryIds.clear();
+    userIds.clear();
+    titles.clear();
+    titleEnds.clear();
+    categories.clear();
+}
+
+void TaskStore::Reserve(size_t rows, size_t titleBytes) {
+    ids.reserve(rows);
+    dueDays.reserve(rows);
+    priorities.reserve(rows);
+    completed.reserve(rows);
+    categoryIds.reserve(rows);
+    userIds.reserve(rows);
+    titleEnds.reserve(rows);
+    titles.reserve(titleBytes);
+}
+
+void TaskStore::Append(int id, std::string_view titleUtf8, int dueDay, int priority, bool isCompleted,
+                       int categoryId, const CategoryInfoPtr& category, int userId) {
+    ids.push_back(id);
+    dueDays.push_back(dueDay);
+    priorities.push_back(priority);
+    completed.push_back(isCompleted);
+    categoryIds.push_back(categoryId);
+    userIds.push_back(userId);
+
+    titles.append(titleUtf8.data(), titleUtf8.size());
+    titleEnds.push_back(static_cast<uint32_t>(titles.size()));
+
+    if (category && categories.find(categoryId) == categories.end()) {
+        categories.emplace(categoryId, category);
+    }
+}
+
+void TaskStore::Append(const TaskStore& rows) {
+    for (size_t row = 0; row < rows.GetCount(); ++row) {
+        Append(rows.ids[row], rows.GetTitleUtf8(row), rows.dueDays[row], rows.priorities[row],
+               rows.completed[row], rows.categoryIds[row], rows.GetCategory(row), rows.userIds[row]);
+    }
+}
+
+void TaskStore::Insert(size_t row, const Task& task) {
+    ids.insert(ids.begin() + row, task.id);
+    dueDays.insert(dueDays.begin() + row, task.dueDay);
+    priorities.insert(priorities.begin() + row, task.priority);
+    completed.insert(completed.begin() + row, task.completed);
+    categoryIds.insert(categoryIds.begin() + row, task.categoryId);
+    userIds.insert(userIds.begin() + row, task.userId);
+
+    wxCharBuffer title = task.title.ToUTF8();
+    uint32_t begin = row > 0 ? titleEnds[row - 1] : 0;
+    uint32_t length = static_cast<uint32_t>(title.length());
+    titles.insert(begin, title.data(), length);
+    titleEnds.insert(titleEnds.begin() + row, begin + length);
+    for (size_t next = row + 1; next < titleEnds.size(); ++next) {
+        titleEnds[next] += length;
+    }
+
+    if (task.category && categories.find(task.categoryId) == categories.end()) {
+        categories.emplace(task.categoryId, task.category);
+    }
+}
+
+void TaskStore::Replace(size_t row, const Task& task) {
+    Erase(row);
+    Insert(row, task);
+}
+
+void TaskStore::Erase(size_t row) {
+    ids.erase(ids.begin() + row);
+    dueDays.erase(dueDays.begin() + row);
+    priorities.erase(priorities.begin() + row);
+    completed.erase(completed.begin() + row);
+    categoryIds.erase(categoryIds.begin() + row);
+    userIds.erase(userIds.begin() + row);
+
+    uint32_t begin = row > 0 ? titleEnds[row - 1] : 0;
+    uint32_t length = titleEnds[row] - begin;
+    titles.erase(begin, length);
+    titleEnds.erase(titleEnds.begin() + row);
+    for (size_t next = row; next < titleEnds.size(); ++next) {
+        titleEnds[next] -= length;
+    }
+}
+
+int TaskStore::FindRow(int id) const {
+    auto found = std::find(ids.begin(), ids.end(), id);
+    return found != ids.end() ? static_cast<int>(found - ids.begin()) : -1;
+}
+
+void TaskStore::ResolveCategories(CategoryManager& manager) {
+    for (auto& entry : categories) {
+        entry.second = manager.GetCategoryInfo(entry.first);
+    }
+}
+
+std::string_view TaskStore::GetTitleUtf8(size_t row) const {
+    size_t begin = row > 0 ? titleEnds[row - 1] : 0;
+    return std::string_view(titles.data() + begin, titleEnds[row] - begin);
+}
+
+wxString TaskStore::GetTitle(size_t row) const {
+    std::string_view title = GetTitleUtf8(row);
+    return wxString::FromUTF8(title.data(), title.size());
+}
+
+CategoryInfoPtr TaskStore::GetCategory(size_t row) const {
+    auto found = categories.find(categoryIds[row]);
+    return found != categories.end() ? found->second : CategoryManager::GetNoCategoryInfo();
+}
+
+void TaskStore::GetTask(size_t row, Task& task) const {
+    task.id = ids[row];
+    task.title = GetTitle(row);
+    task.description.clear();
+    task.dueDay = dueDays[row];
+    task.priority = priorities[row];
+    task.completed = completed[row];
+    task.categoryId = categoryIds[row];
+    task.category = GetCategory(row);
+    task.userId = userIds[row];
+}
+
+size_t TaskStore::CountCompleted() const {
+    return std::count(completed.begin(), completed.end(), true);
+}
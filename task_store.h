@@ -0,0 +1,75 @@
+#ifndef TASK_STORE_H
+#define TASK_STORE_H
+
+#include <wx/wx.h>
+#include "category_manager.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Task;
+
+// Column-wise storage for the tasks shown in the main window.
+//
+// Each field lives in its own contiguous array, titles are packed as
+// UTF-8 into a single arena, and descriptions are not kept at all; the
+// grid never shows them and DatabaseManager::GetTaskDescription loads one
+// when a task is opened. A row costs a few dozen bytes and no allocation
+// of its own, and scanning a column touches only that column's memory.
+class TaskStore {
+public:
+    size_t GetCount() const { return ids.size(); }
+    bool IsEmpty() const { return ids.empty(); }
+
+    void Clear();
+    void Reserve(size_t rows, size_t titleBytes = 0);
+
+    void Append(int id, std::string_view titleUtf8, int dueDay, int priority, bool completed,
+                int categoryId, const CategoryInfoPtr& category, int userId);
+    // Appends every row of rows
+    void Append(const TaskStore& rows);
+
+    // Edits a single row in place; each moves the rows after it, so they
+    // are meant for pages and result lists, not for building a store
+    void Insert(size_t row, const Task& task);
+    void Replace(size_t row, const Task& task);
+    void Erase(size_t row);
+    // Row holding the task, or -1
+    int FindRow(int id) const;
+
+    // Replaces the category records with the ones interned by manager,
+    // e.g. for rows read on a connection without a CategoryManager
+    void ResolveCategories(CategoryManager& manager);
+
+    int GetId(size_t row) const { return ids[row]; }
+    std::string_view GetTitleUtf8(size_t row) const;
+    wxString GetTitle(size_t row) const;
+    int GetDueDay(size_t row) const { return dueDays[row]; }
+    int GetPriority(size_t row) const { return priorities[row]; }
+    bool IsCompleted(size_t row) const { return completed[row]; }
+    int GetCategoryId(size_t row) const { return categoryIds[row]; }
+    CategoryInfoPtr GetCategory(size_t row) const;
+    int GetUserId(size_t row) const { return userIds[row]; }
+
+    // Fills task from a row; the description is left empty
+    void GetTask(size_t row, Task& task) const;
+
+    size_t CountCompleted() const;
+
+private:
+    std::vector<int> ids;
+    std::vector<int> dueDays;       // See due_date.h
+    std::vector<int> priorities;
+    std::vector<bool> completed;
+    std::vector<int> categoryIds;   // -1 for no category
+    std::vector<int> userIds;
+
+    std::string titles;                 // UTF-8 titles back to back
+    std::vector<uint32_t> titleEnds;    // End of each row's title in titles
+
+    // One record per distinct category id in the store
+    std::unordered_map<int, CategoryInfoPtr> categories;
+};
+
+#endif // TASK_STORE_H
@@ -0,0 +1,18 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+
+// Like assert, but also checked in release builds; the tests exit with
+// status 1 at the first failure for ctest to report
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__                            \
+                      << ": CHECK failed: " #condition << std::endl;            \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+#endif // TESTS_CHECK_H
@@ -0,0 +1,263 @@
+// Reads from the ConnectionPool on several threads while a bulk CSV
+// import writes through the writer connection, and checks that the
+// readers never wait for the writer and never see half of a commit.
+//
+// The import commits in chunks. Every lease must see a whole number of
+// chunks, and the same number in the listing count, the trigger-kept
+// task_stats totals and the full-text index, even with a pause between
+// its queries. From inside the import's open transaction, a lease is
+// also taken on another thread and must finish before the writer goes
+// on; a reader blocked on the write lock would time out there. Another
+// lease is held open from one progress call to the next, across chunk
+// commits: it must keep seeing the same counts, and the writer must not
+// wait for it to end.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "connection_pool.h"
+#include "task_importer.h"
+#include "user_manager.h"
+#include "check.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* DB_FILE = "connection_pool_stress_test.db";
+const char* CSV_FILE = "connection_pool_stress_test.csv";
+const int USER_ID = 1;
+const int IMPORT_ROWS = 20000;
+const int CHUNK_ROWS = 600;
+// Not a multiple of CHUNK_ROWS, so that most progress calls come with
+// rows inserted but not committed
+const int PROGRESS_ROWS = 1000;
+const int READER_THREADS = 2;
+// The reading threads, the probe and the lease held across commits
+const int POOL_READERS = READER_THREADS + 2;
+// A reader waiting on the writer would sit out the busy timeout first
+const std::chrono::seconds PROBE_TIMEOUT(3);
+
+typedef std::chrono::steady_clock Clock;
+
+void RemoveDatabase() {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::remove((std::string(DB_FILE) + suffix).c_str());
+    }
+}
+
+void WriteCsv() {
+    std::ofstream csv(CSV_FILE, std::ios::binary);
+    csv << "ID,Title,Description,Due Date,Priority,Category,Completed\n";
+    for (int i = 0; i < IMPORT_ROWS; ++i) {
+        csv << i << ",\"Imported, " << i << "\",\"Line one\nline two\",2025-01-"
+            << (i % 28 + 1) << "," << (i % 5 + 1) << ",," << (i % 3 == 0 ? "Yes" : "No") << "\n";
+    }
+}
+
+struct Snapshot {
+    int listed;
+    int total;
+    int completed;
+    int indexed;    // Rows in the full-text index, or listed without one
+};
+
+int QueryInt(wxSQLite3Database* db, const char* sql) {
+    wxSQLite3ResultSet set = db->ExecuteQuery(sql);
+    CHECK(set.NextRow());
+    return set.GetAsInt(0);
+}
+
+// Reads the counts in one lease, pausing between queries so that
+// commits land in the middle
+Snapshot ReadSnapshot(ConnectionPool::Reader& reader, bool pause) {
+    Snapshot snapshot;
+    snapshot.listed = reader->CountTasks(USER_ID, TaskFilter());
+    if (pause) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    TaskStatistics stats;
+    CHECK(reader->GetTaskStatistics(USER_ID, wxDateTime(1, wxDateTime::Jan, 2025), stats));
+    snapshot.total = stats.total;
+    snapshot.completed = stats.completed;
+    if (pause) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    snapshot.indexed = reader->HasFullTextSearch()
+        ? QueryInt(reader->GetDatabase(), "SELECT COUNT(*) FROM tasks_fts")
+        : snapshot.listed;
+    return snapshot;
+}
+
+void CheckSnapshot(const Snapshot& snapshot) {
+    CHECK(snapshot.listed % CHUNK_ROWS == 0 || snapshot.listed == IMPORT_ROWS);
+    CHECK(snapshot.listed <= IMPORT_ROWS);
+    CHECK(snapshot.total == snapshot.listed);
+    CHECK(snapshot.indexed == snapshot.listed);
+    // Rows 0, 3, 6... are completed
+    CHECK(snapshot.completed == (snapshot.listed + 2) / 3);
+}
+
+} // namespace
+
+int main() {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    RemoveDatabase();
+    WriteCsv();
+
+    DatabaseTuning tuning;
+    CHECK(DatabaseTuning::FromName("balanced", tuning));
+
+    DatabaseManager writer;
+    writer.SetShowErrors(false);
+    CHECK(writer.Connect(DB_FILE, tuning));
+    UserManager users(writer.GetDatabase());
+    CHECK(users.InitializeUserTable());
+    CategoryManager categories(writer.GetDatabase());
+    CHECK(categories.InitializeCategoryTable());
+    writer.SetCategoryManager(&categories);
+
+    ConnectionPool pool(&writer);
+    CHECK(pool.Open(POOL_READERS));
+    CHECK(pool.GetReaderCount() == POOL_READERS);
+
+    std::atomic<bool> importing(true);
+    std::atomic<long> leases(0);
+    std::atomic<long> leasesDuringImport(0);
+    std::atomic<long long> slowestLeaseUs(0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < READER_THREADS; ++i) {
+        threads.emplace_back([&] {
+            int lastSeen = 0;
+            do {
+                bool duringImport = importing;
+                Clock::time_point start = Clock::now();
+                {
+                    ConnectionPool::Reader reader = pool.AcquireReader();
+                    CHECK(reader);
+                    Snapshot snapshot = ReadSnapshot(reader, true);
+                    CheckSnapshot(snapshot);
+                    // Snapshots only move forward
+                    CHECK(snapshot.listed >= lastSeen);
+                    lastSeen = snapshot.listed;
+                }
+                long long us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+                long long slowest = slowestLeaseUs;
+                while (us > slowest && !slowestLeaseUs.compare_exchange_weak(slowest, us)) {
+                }
+                ++leases;
+                if (duringImport) {
+                    ++leasesDuringImport;
+                }
+            } while (importing);
+        });
+    }
+
+    int probes = 0;
+    ConnectionPool::Reader heldLease;
+    Snapshot heldSnapshot = Snapshot();
+    TaskImporter importer(&writer, &categories, USER_ID);
+    importer.SetChunkSize(CHUNK_ROWS);
+    importer.SetProgressInterval(PROGRESS_ROWS);
+    Clock::time_point start = Clock::now();
+    ImportResult result = importer.ImportCsv(CSV_FILE, [&](int rowsRead, wxFileOffset, wxFileOffset) {
+        // The import's transaction is open here, and unless a chunk was
+        // just committed it holds the write lock
+        CHECK(!writer.GetDatabase()->GetAutoCommit());
+        std::future<Snapshot> probe = std::async(std::launch::async, [&] {
+            ConnectionPool::Reader reader = pool.AcquireReader();
+            CHECK(reader);
+            return ReadSnapshot(reader, false);
+        });
+        CHECK(probe.wait_for(PROBE_TIMEOUT) == std::future_status::ready);
+        Snapshot snapshot = probe.get();
+        CheckSnapshot(snapshot);
+        // Only the committed chunks are visible
+        CHECK(snapshot.listed == rowsRead / CHUNK_ROWS * CHUNK_ROWS);
+        ++probes;
+
+        // Chunks were committed since the held lease read its counts
+        if (heldLease) {
+            Snapshot again = ReadSnapshot(heldLease, false);
+            CHECK(again.listed == heldSnapshot.listed);
+            CHECK(again.total == heldSnapshot.total);
+            CHECK(again.indexed == heldSnapshot.indexed);
+            CHECK(heldSnapshot.listed < snapshot.listed);
+            heldLease.Release();
+        }
+        heldLease = pool.AcquireReader();
+        CHECK(heldLease);
+        heldSnapshot = ReadSnapshot(heldLease, false);
+        return true;
+    });
+    double importMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    heldLease.Release();
+    importing = false;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(result.error.IsEmpty());
+    CHECK(result.imported == IMPORT_ROWS);
+    CHECK(probes == IMPORT_ROWS / PROGRESS_ROWS);
+    CHECK(leasesDuringImport > 0);
+
+    {
+        ConnectionPool::Reader reader = pool.AcquireReader();
+        Snapshot snapshot = ReadSnapshot(reader, false);
+        CheckSnapshot(snapshot);
+        CHECK(snapshot.listed == IMPORT_ROWS);
+
+        // Readers are opened with query_only
+        bool refused = false;
+        try {
+            reader->GetDatabase()->ExecuteUpdate("DELETE FROM tasks");
+        } catch (wxSQLite3Exception&) {
+            refused = true;
+        }
+        CHECK(refused);
+    }
+
+    // Readers build their category records without wxColour
+    int workId = categories.AddCategory("Work", "#336699", "", USER_ID);
+    int namedId = categories.AddCategory("Named", "red", "", USER_ID);
+    CHECK(writer.AddTask("Filed", "", NO_DUE_DATE, 3, workId, USER_ID));
+    CHECK(writer.AddTask("Named", "", NO_DUE_DATE, 3, namedId, USER_ID));
+    {
+        ConnectionPool::Reader reader = pool.AcquireReader();
+        int found = 0;
+        for (const Task& task : reader->GetAllTasks(USER_ID)) {
+            if (task.category->id == workId) {
+                CHECK(task.category->name == "Work");
+                CHECK(task.category->hasColor && task.category->rgb == 0x336699);
+                CHECK(task.category->darkText == false);
+                ++found;
+            } else if (task.category->id == namedId) {
+                CHECK(!task.category->hasColor);
+                ++found;
+            }
+        }
+        CHECK(found == 2);
+    }
+
+    std::cout << "Imported " << IMPORT_ROWS << " rows in " << importMs << " ms; "
+              << leases << " leases (" << leasesDuringImport << " during the import), "
+              << probes << " probes inside the write transaction, slowest lease "
+              << slowestLeaseUs / 1000.0 << " ms" << std::endl;
+
+    std::remove(CSV_FILE);
+    RemoveDatabase();
+    return 0;
+}
@@ -0,0 +1,202 @@
+// Fuzz test of CsvReader, built with AddressSanitizer on GCC and Clang.
+//
+// Records with random fields, quoting and line endings are written out
+// as RFC 4180 text and must be read back unchanged. Arbitrary bytes must
+// be read without a crash, consuming the whole input, into the same
+// records whatever the buffer size, so that the paths which refill, move
+// and grow the buffer all agree with reading it in one piece.
+//
+// Built with -DCSV_READER_LIBFUZZER and -fsanitize=fuzzer, the same
+// checks run on libFuzzer's inputs instead; see tests/CMakeLists.txt.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include <wx/mstream.h>
+#include "csv_reader.h"
+#include "check.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::vector<std::string> Record;
+
+struct ReadRecord {
+    Record fields;
+    bool malformed;
+
+    bool operator==(const ReadRecord& other) const {
+        return fields == other.fields && malformed == other.malformed;
+    }
+};
+
+// Hands out at most maxRead bytes per call, so that records arrive in
+// pieces as from a pipe
+class ChunkedInputStream : public wxInputStream {
+public:
+    ChunkedInputStream(const std::string& data, size_t maxRead)
+        : data(data), position(0), maxRead(maxRead) {}
+
+    wxFileOffset GetLength() const override { return static_cast<wxFileOffset>(data.size()); }
+
+protected:
+    size_t OnSysRead(void* buffer, size_t size) override {
+        size_t count = std::min(std::min(size, maxRead), data.size() - position);
+        if (count == 0) {
+            m_lasterror = wxSTREAM_EOF;
+            return 0;
+        }
+        memcpy(buffer, data.data() + position, count);
+        position += count;
+        return count;
+    }
+
+private:
+    const std::string& data;
+    size_t position;
+    size_t maxRead;
+};
+
+std::vector<ReadRecord> ReadAll(const std::string& text, size_t bufferSize, size_t maxRead) {
+    ChunkedInputStream input(text, maxRead);
+    CsvReader reader(input, bufferSize);
+
+    std::vector<ReadRecord> records;
+    while (reader.NextRecord()) {
+        CHECK(reader.GetRecordNumber() == records.size() + 1);
+        CHECK(reader.GetFieldCount() > 0);
+        ReadRecord record;
+        for (size_t i = 0; i < reader.GetFieldCount(); ++i) {
+            record.fields.emplace_back(reader.GetField(i));
+        }
+        record.malformed = reader.IsMalformed();
+        records.push_back(record);
+    }
+    CHECK(reader.GetBytesRead() == static_cast<wxFileOffset>(text.size()));
+    // Reading past the end stays at the end
+    CHECK(!reader.NextRecord());
+    return records;
+}
+
+// Any input: every way of reading it gives the records read in one piece
+void CheckInput(const std::string& text) {
+    std::vector<ReadRecord> whole = ReadAll(text, text.size() + 1, text.size() + 1);
+    for (size_t bufferSize : {1, 2, 3, 5, 16, 64}) {
+        for (size_t maxRead : {1, 3, 1024}) {
+            CHECK(ReadAll(text, bufferSize, maxRead) == whole);
+        }
+    }
+}
+
+} // namespace
+
+#ifdef CSV_READER_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static wxInitializer initializer;
+    CheckInput(std::string(reinterpret_cast<const char*>(data), size));
+    return 0;
+}
+
+#else
+
+namespace {
+
+std::string Escape(const std::string& field, bool quote) {
+    if (!quote) {
+        return field;
+    }
+    std::string escaped = "\"";
+    for (char c : field) {
+        escaped += c;
+        if (c == '"') {
+            escaped += '"';
+        }
+    }
+    return escaped + "\"";
+}
+
+// Random records written out and read back
+void RoundTrip(std::mt19937& random) {
+    static const char* const PIECES[] = {
+        "a", "b", "Task", " ", ",", "\"", "\n", "\r", "\r\n", "\xC3\xA9", "\xE2\x82\xAC", "\t"
+    };
+    const size_t pieceCount = sizeof(PIECES) / sizeof(PIECES[0]);
+
+    std::vector<Record> records(random() % 6 + 1);
+    std::string text = random() % 4 == 0 ? "\xEF\xBB\xBF" : "";
+    for (size_t r = 0; r < records.size(); ++r) {
+        size_t fieldCount = random() % 5 + 1;
+        for (size_t f = 0; f < fieldCount; ++f) {
+            std::string field;
+            for (int length = random() % 6; length > 0; --length) {
+                field += PIECES[random() % pieceCount];
+            }
+            records[r].push_back(field);
+
+            // Quoted when it has to be, and sometimes when it need not;
+            // a lone empty field would otherwise read as a blank line
+            bool quote = field.find_first_of(",\"\r\n") != std::string::npos ||
+                         (fieldCount == 1 && field.empty()) || random() % 4 == 0;
+            if (f > 0) {
+                text += ',';
+            }
+            text += Escape(field, quote);
+        }
+        // The last record may end without a line break
+        if (r + 1 < records.size() || random() % 2 == 0) {
+            text += random() % 2 == 0 ? "\r\n" : "\n";
+        }
+    }
+
+    std::vector<ReadRecord> read = ReadAll(text, random() % 32 + 1, random() % 8 + 1);
+    CHECK(read.size() == records.size());
+    for (size_t r = 0; r < records.size(); ++r) {
+        CHECK(!read[r].malformed);
+        CHECK(read[r].fields == records[r]);
+    }
+    CheckInput(text);
+}
+
+// Short strings over the characters the reader treats specially
+std::string RandomBytes(std::mt19937& random) {
+    static const char ALPHABET[] = {',', '"', '\r', '\n', 'x', ' ', '\xEF', '\xBB', '\xBF', '\0'};
+    std::string text;
+    for (int length = random() % 40; length > 0; --length) {
+        text += ALPHABET[random() % sizeof(ALPHABET)];
+    }
+    return text;
+}
+
+} // namespace
+
+int main() {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    // Fixed seed, so that a failure can be reproduced
+    std::mt19937 random(4180);
+    for (int i = 0; i < 5000; ++i) {
+        RoundTrip(random);
+    }
+    for (int i = 0; i < 5000; ++i) {
+        CheckInput(RandomBytes(random));
+    }
+
+    // A record much larger than the buffer it starts in
+    std::string large = "\"" + std::string(100000, 'x') + "\n\"\"\",y\n";
+    for (size_t bufferSize : {size_t(16), CsvReader::DEFAULT_BUFFER_SIZE}) {
+        std::vector<ReadRecord> records = ReadAll(large, bufferSize, 1000);
+        CHECK(records.size() == 1);
+        CHECK(records[0].fields.size() == 2);
+        CHECK(records[0].fields[0] == std::string(100000, 'x') + "\n\"");
+        CHECK(records[0].fields[1] == "y");
+    }
+    return 0;
+}
+
+#endif
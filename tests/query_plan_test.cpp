@@ -0,0 +1,275 @@
+// Checks that the hot queries keep using the indexes the schema
+// migrations create. Each query is run through its DatabaseManager or
+// CategoryManager method with statement tracing on, and the EXPLAIN QUERY
+// PLAN of every statement it ran must not scan a table: a SCAN other than
+// of a virtual table fails the test, as does a temporary B-tree sort of a
+// listing that the indexes already deliver in order.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "database_manager.h"
+#include "category_manager.h"
+#include "user_manager.h"
+#include "check.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* UPGRADE_DB = "query_plan_test.db";
+
+// SQL of the statements a piece of code runs, in order, each listed once
+class StatementLog {
+public:
+    explicit StatementLog(sqlite3* db) : db(db) {
+        sqlite3_trace_v2(db, SQLITE_TRACE_STMT, &StatementLog::OnTrace, this);
+    }
+    ~StatementLog() { sqlite3_trace_v2(db, 0, nullptr, nullptr); }
+
+    const std::vector<std::string>& GetStatements() const { return statements; }
+
+private:
+    sqlite3* db;
+    std::vector<std::string> statements;
+
+    static int OnTrace(unsigned type, void* log, void* p, void* x) {
+        StatementLog* self = static_cast<StatementLog*>(log);
+        const char* sql = sqlite3_sql(static_cast<sqlite3_stmt*>(p));
+        // Trigger programs are reported with their own "--" text
+        if (sql == nullptr || std::string(static_cast<const char*>(x)).rfind("--", 0) == 0) {
+            return 0;
+        }
+        for (const std::string& seen : self->statements) {
+            if (seen == sql) {
+                return 0;
+            }
+        }
+        self->statements.push_back(sql);
+        return 0;
+    }
+};
+
+bool IsTransactionControl(const std::string& sql) {
+    for (const char* keyword : {"BEGIN", "COMMIT", "ROLLBACK", "SAVEPOINT", "RELEASE", "PRAGMA"}) {
+        if (sql.rfind(keyword, 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs code and checks the plan of each statement it ran. With ordered,
+// a listing must also come out of an index in order.
+void CheckPlans(DatabaseManager& manager, const char* name, bool ordered,
+                const std::function<void()>& code) {
+    sqlite3* db = manager.GetDatabase()->GetDatabaseHandle();
+    std::vector<std::string> statements;
+    {
+        StatementLog log(db);
+        code();
+        statements = log.GetStatements();
+    }
+    CHECK(!statements.empty());
+
+    for (const std::string& sql : statements) {
+        if (IsTransactionControl(sql)) {
+            continue;
+        }
+
+        sqlite3_stmt* explain = nullptr;
+        CHECK(sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &explain, nullptr) == SQLITE_OK);
+
+        std::cout << name << ": " << sql << std::endl;
+        bool passed = true;
+        while (sqlite3_step(explain) == SQLITE_ROW) {
+            std::string detail = reinterpret_cast<const char*>(sqlite3_column_text(explain, 3));
+            std::cout << "    " << detail << std::endl;
+
+            bool scan = detail.rfind("SCAN ", 0) == 0 &&
+                        detail.find("VIRTUAL TABLE") == std::string::npos &&
+                        detail != "SCAN CONSTANT ROW";
+            bool sort = ordered && detail.find("USE TEMP B-TREE FOR") != std::string::npos;
+            if (scan || sort) {
+                std::cerr << name << ": " << detail << " in " << sql << std::endl;
+                passed = false;
+            }
+        }
+        sqlite3_finalize(explain);
+        CHECK(passed);
+    }
+}
+
+void AddTasks(DatabaseManager& manager, int categoryId) {
+    manager.GetDatabase()->ExecuteUpdate("BEGIN");
+    for (int i = 0; i < 200; ++i) {
+        CHECK(manager.AddTask(wxString::Format("Task %d", i), "Plan check", i % 2 == 0 ? 19000 + i : NO_DUE_DATE,
+                              i % 3 + 1, i % 4 == 0 ? categoryId : -1, 1));
+    }
+    manager.GetDatabase()->ExecuteUpdate("COMMIT");
+}
+
+void CheckHotQueries(DatabaseManager& manager, CategoryManager& categories) {
+    int categoryId = categories.AddCategory("Plans", "#336699", "", 1);
+    CHECK(categoryId > 0);
+    AddTasks(manager, categoryId);
+
+    TaskFilter all;
+    TaskFilter pending;
+    pending.includeCompleted = false;
+    int total = manager.CountTasks(1, all);
+    CHECK(total >= 200);
+
+    for (const TaskFilter& filter : {all, pending}) {
+        const char* name = filter.includeCompleted ? "GetTasksPage(all)" : "GetTasksPage(pending)";
+        CheckPlans(manager, name, true, [&] {
+            TaskPage first;
+            CHECK(manager.GetTasksPage(1, filter, nullptr, 50, first));
+            CHECK(first.tasks.GetCount() == 50);
+            TaskPage next;
+            CHECK(manager.GetTasksPage(1, filter, &first.lastKey, 50, next));
+            CHECK(next.tasks.GetCount() == 50);
+        });
+        CheckPlans(manager, "GetTaskKeyAt", true, [&] {
+            TaskKey key;
+            CHECK(manager.GetTaskKeyAt(1, filter, nullptr, 60, key));
+        });
+        CheckPlans(manager, "CountTasks", false, [&] {
+            CHECK(manager.CountTasks(1, filter) > 0);
+        });
+    }
+
+    CheckPlans(manager, "GetTasksPageWithDescriptions", true, [&] {
+        std::vector<Task> first;
+        CHECK(manager.GetTasksPageWithDescriptions(1, all, nullptr, 50, first));
+        CHECK(first.size() == 50);
+        TaskKey lastKey = TaskKey::Of(first.back());
+        std::vector<Task> next;
+        CHECK(manager.GetTasksPageWithDescriptions(1, all, &lastKey, 50, next));
+        CHECK(next.size() == 50 && TaskKey::Of(first.back()) < TaskKey::Of(next.front()));
+    });
+    std::vector<Task> tasks = manager.GetAllTasks(1);
+    CheckPlans(manager, "GetTaskDescriptions", false, [&] {
+        std::unordered_map<int, wxString> descriptions;
+        CHECK(manager.GetTaskDescriptions({tasks[10].id, tasks[20].id}, descriptions));
+        CHECK(descriptions.size() == 2 && descriptions[tasks[10].id] == tasks[10].description);
+    });
+    CheckPlans(manager, "GetRecentTasks", true, [&] {
+        CHECK(manager.GetRecentTasks(1, 10).size() == 10);
+    });
+    CheckPlans(manager, "GetTaskStatistics", false, [&] {
+        TaskStatistics stats;
+        CHECK(manager.GetTaskStatistics(1, wxDateTime::Today(), stats));
+        CHECK(stats.total == total);
+    });
+    CheckPlans(manager, "GetAllTasks", true, [&] {
+        CHECK(static_cast<int>(manager.GetAllTasks(1).size()) == total);
+    });
+    if (manager.HasFullTextSearch()) {
+        CheckPlans(manager, "SearchTasks", false, [&] {
+            TaskSearch search;
+            search.text = "plan";
+            search.field = TaskSearch::ALL_FIELDS;
+            search.priority = 0;
+            search.fromDay = NO_DUE_DATE;
+            search.toDay = NO_DUE_DATE;
+            search.categoryId = -1;
+            search.includeCompleted = true;
+            TaskStore results;
+            CHECK(manager.SearchTasks(1, search, results));
+            CHECK(results.GetCount() == 200);
+        });
+    }
+    std::vector<int> ids = {tasks[0].id, tasks[1].id, tasks[2].id};
+    CheckPlans(manager, "EditTasks", false, [&] {
+        std::vector<TaskChange> changes;
+        CHECK(manager.EditTasks(ids, TaskBatchEdit{TaskBatchEdit::SET_PRIORITY, 2}, changes));
+        CHECK(changes.size() == 3);
+    });
+    CheckPlans(manager, "DeleteCategory", false, [&] {
+        CHECK(categories.DeleteCategory(categoryId));
+    });
+}
+
+// A fresh database, migrated from nothing
+void TestNewDatabase() {
+    DatabaseManager manager;
+    manager.SetShowErrors(false);
+    CHECK(manager.Connect(":memory:"));
+    CHECK(manager.GetSchemaVersion() == DatabaseManager::GetLatestSchemaVersion());
+
+    UserManager users(manager.GetDatabase());
+    CHECK(users.InitializeUserTable());
+    CategoryManager categories(manager.GetDatabase());
+    CHECK(categories.InitializeCategoryTable());
+    manager.SetCategoryManager(&categories);
+
+    CheckHotQueries(manager, categories);
+}
+
+// A database made before the migrations, with the original tasks table
+// and its TEXT due dates, upgraded in place
+void TestUpgradedDatabase() {
+    std::remove(UPGRADE_DB);
+    {
+        wxSQLite3Database db;
+        db.Open(UPGRADE_DB);
+        db.ExecuteUpdate(
+            "CREATE TABLE tasks ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "title TEXT NOT NULL, "
+            "description TEXT, "
+            "due_date TEXT, "
+            "priority INTEGER, "
+            "completed INTEGER DEFAULT 0, "
+            "category_id INTEGER, "
+            "user_id INTEGER, "
+            "FOREIGN KEY(category_id) REFERENCES categories(id), "
+            "FOREIGN KEY(user_id) REFERENCES users(id))"
+        );
+        db.ExecuteUpdate("INSERT INTO tasks (title, due_date, priority, completed, user_id) "
+                         "VALUES ('Old', '2024-03-01', 2, 0, 1), ('Undated', '', 1, 1, 1), ('Deleted', '', 1, 0, 1)");
+        db.ExecuteUpdate("DELETE FROM tasks WHERE title = 'Deleted'");
+    }
+
+    {
+        DatabaseManager manager;
+        manager.SetShowErrors(false);
+        CHECK(manager.Connect(UPGRADE_DB));
+        CHECK(manager.GetSchemaVersion() == DatabaseManager::GetLatestSchemaVersion());
+
+        UserManager users(manager.GetDatabase());
+        CHECK(users.InitializeUserTable());
+        CategoryManager categories(manager.GetDatabase());
+        CHECK(categories.InitializeCategoryTable());
+        manager.SetCategoryManager(&categories);
+
+        std::vector<Task> tasks = manager.GetAllTasks(1);
+        CHECK(tasks.size() == 2);
+        CHECK(tasks[0].title == "Undated" && tasks[0].dueDay == NO_DUE_DATE);
+        CHECK(tasks[1].title == "Old" && tasks[1].dueDay == DueDayFromDateTime(wxDateTime(1, wxDateTime::Mar, 2024)));
+
+        // The rebuilt table keeps the AUTOINCREMENT high-water mark, so the
+        // deleted task's id is not handed out again
+        wxSQLite3ResultSet seq = manager.GetDatabase()->ExecuteQuery(
+            "SELECT seq FROM sqlite_sequence WHERE name = 'tasks'");
+        CHECK(seq.NextRow() && seq.GetAsInt(0) == 3);
+
+        CheckHotQueries(manager, categories);
+    }
+    std::remove(UPGRADE_DB);
+}
+
+} // namespace
+
+int main() {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    TestNewDatabase();
+    TestUpgradedDatabase();
+    return 0;
+}
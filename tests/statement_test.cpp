@@ -0,0 +1,196 @@
+// Runs the prepare/step/reset cycle of wxSQLite3Statement and
+// wxSQLite3ResultSet many times over, with the statement cache enabled,
+// evicting and disabled. Built with AddressSanitizer, which turns a
+// double finalize, a use of a finalized statement or a leaked one into a
+// failure.
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include "wxsqlite3/wxsqlite3.h"
+#include "check.h"
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const int ROWS = 200;
+const int ITERATIONS = 2000;
+
+void CreateTable(wxSQLite3Database& db) {
+    db.ExecuteUpdate("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT, data BLOB)");
+    db.ExecuteUpdate("BEGIN");
+    wxSQLite3Statement insert = db.PrepareStatement("INSERT INTO items (id, name, data) VALUES (?, ?, ?)");
+    for (int i = 1; i <= ROWS; ++i) {
+        insert.Bind(1, i);
+        insert.Bind(2, wxString::Format("item %d", i));
+        if (i % 10 == 0) {
+            insert.BindNull(3);
+        } else {
+            insert.Bind(3, wxString::Format("blob %d", i));
+        }
+        CHECK(insert.ExecuteUpdate() == 1);
+        insert.Reset();
+    }
+    db.ExecuteUpdate("COMMIT");
+}
+
+// Re-runs statements kept alive across calls and statements taken from
+// the cache, stopping some result sets early
+void RunCycle(wxSQLite3Database& db) {
+    wxSQLite3Statement byId = db.PrepareStatement("SELECT name, data FROM items WHERE id = ?");
+    for (int i = 0; i < ITERATIONS; ++i) {
+        int id = i % ROWS + 1;
+        byId.Bind(1, id);
+        wxSQLite3ResultSet set = byId.ExecuteQuery();
+        CHECK(set.NextRow());
+        CHECK(set.GetAsStringView(0) == std::string(wxString::Format("item %d", id).ToUTF8()));
+        CHECK(set.IsNull(1) == (id % 10 == 0));
+        CHECK(!set.NextRow());
+        byId.Reset();
+
+        // A new handle each time; with a cache it is the same sqlite3_stmt
+        wxSQLite3Statement range = db.PrepareStatement("SELECT id FROM items WHERE id > ? ORDER BY id");
+        range.Bind(1, id);
+        wxSQLite3ResultSet rows = range.ExecuteQuery();
+        int expected = id + 1;
+        // Half of the runs leave the result set before the end
+        int stopAt = i % 2 == 0 ? ROWS : id + 5;
+        while (expected <= stopAt && rows.NextRow()) {
+            CHECK(rows.GetAsInt(0) == expected);
+            ++expected;
+        }
+    }
+}
+
+void TestStatementCycle(size_t cacheSize) {
+    wxSQLite3Database db;
+    db.Open(":memory:");
+    db.SetStatementCacheSize(cacheSize);
+    CreateTable(db);
+    RunCycle(db);
+
+    if (cacheSize >= 2) {
+        CHECK(db.GetStatementCacheHits() > 0);
+    } else if (cacheSize == 0) {
+        CHECK(db.GetCachedStatementCount() == 0);
+    }
+    CHECK(db.GetCachedStatementCount() <= cacheSize);
+}
+
+void TestMoves() {
+    wxSQLite3Database db;
+    db.Open(":memory:");
+    CreateTable(db);
+
+    wxSQLite3Statement first = db.PrepareStatement("SELECT COUNT(*) FROM items WHERE id <= ?");
+    wxSQLite3Statement second(std::move(first));
+    CHECK(!first.IsValid());
+    CHECK(second.IsValid());
+
+    // Assigning over a live statement gives the old one back
+    wxSQLite3Statement third = db.PrepareStatement("SELECT 1");
+    third = std::move(second);
+    CHECK(!second.IsValid());
+    third.Bind(1, 50);
+    {
+        wxSQLite3ResultSet set = third.ExecuteQuery();
+        wxSQLite3ResultSet moved(std::move(set));
+        CHECK(!set.IsValid());
+        CHECK(moved.NextRow());
+        CHECK(moved.GetAsInt(0) == 50);
+    }
+
+    // A result set that owns its statement can leave the scope it was
+    // made in and be moved over another one
+    std::vector<wxSQLite3ResultSet> sets;
+    for (int i = 0; i < 50; ++i) {
+        sets.push_back(db.ExecuteQuery(wxString::Format("SELECT name FROM items WHERE id = %d", i + 1)));
+    }
+    for (int i = 0; i < 50; ++i) {
+        CHECK(sets[i].NextRow());
+        CHECK(sets[i].GetAsString(0) == wxString::Format("item %d", i + 1));
+    }
+    sets[0] = std::move(sets[1]);
+    sets[2].Finalize();
+    sets[2].Finalize();
+    sets.clear();
+
+    // Finalizing by hand leaves nothing for the destructor to do
+    wxSQLite3Statement finalized = db.PrepareStatement("SELECT id FROM items");
+    finalized.Finalize();
+    finalized.Finalize();
+    CHECK(!finalized.IsValid());
+}
+
+void TestErrors() {
+    wxSQLite3Database db;
+    db.Open(":memory:");
+    CreateTable(db);
+
+    for (int i = 0; i < 100; ++i) {
+        bool thrown = false;
+        try {
+            db.PrepareStatement("SELECT missing FROM items");
+        } catch (wxSQLite3Exception&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        // A failing step must leave the statement reusable
+        wxSQLite3Statement insert = db.PrepareStatement("INSERT INTO items (id, name) VALUES (?, 'dup')");
+        insert.Bind(1, 1);
+        thrown = false;
+        try {
+            insert.ExecuteUpdate();
+        } catch (wxSQLite3Exception&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}
+
+void TestArrays() {
+    wxSQLite3Database db;
+    db.Open(":memory:");
+    CreateTable(db);
+
+    wxSQLite3Statement select = db.PrepareStatement("SELECT COUNT(*) FROM items WHERE id IN wx_array(?1)");
+    for (int i = 0; i < ITERATIONS; ++i) {
+        std::vector<int64_t> ids;
+        for (int id = 1; id <= i % 40; ++id) {
+            ids.push_back(id * 3);
+        }
+        // Rebinding frees the previous copy of the values
+        select.Bind(1, ids);
+        select.Bind(1, ids);
+        wxSQLite3ResultSet set = select.ExecuteQuery();
+        CHECK(set.NextRow());
+        CHECK(set.GetAsInt(0) == static_cast<int>(ids.size()));
+        select.Reset();
+    }
+
+    std::vector<wxString> names{"item 1", "item 2", "nothing"};
+    wxSQLite3Statement byName = db.PrepareStatement("SELECT COUNT(*) FROM items WHERE name IN wx_array(?1)");
+    byName.Bind(1, names);
+    wxSQLite3ResultSet set = byName.ExecuteQuery();
+    CHECK(set.NextRow());
+    CHECK(set.GetAsInt(0) == 2);
+}
+
+} // namespace
+
+int main() {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        return 1;
+    }
+
+    TestStatementCycle(wxSQLite3Database::DEFAULT_STATEMENT_CACHE_SIZE);
+    TestStatementCycle(1);
+    TestStatementCycle(0);
+    TestMoves();
+    TestErrors();
+    TestArrays();
+    return 0;
+}
@@ -1,23 +1,191 @@
 #include "wxsqlite3.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// wx_array: an eponymous table-valued function over an array bound with
+// sqlite3_bind_pointer, like SQLite's carray extension, which builds of
+// SQLite do not include by default. Its one visible column is value; the
+// hidden array column takes the argument.
+const char* const ARRAY_POINTER_TYPE = "wxsqlite3-array";
+
+struct BoundArray {
+    std::vector<int64_t> numbers;
+    std::vector<std::string> texts;  // UTF-8; used when numbers is empty
+    size_t size() const { return numbers.empty() ? texts.size() : numbers.size(); }
+};
+
+void DeleteBoundArray(void* array) {
+    delete static_cast<BoundArray*>(array);
+}
+
+struct ArrayCursor {
+    sqlite3_vtab_cursor base;
+    const BoundArray* array;  // Null when no array was bound
+    size_t row;
+};
+
+enum { ARRAY_COLUMN_VALUE, ARRAY_COLUMN_ARRAY };
+
+int ArrayConnect(sqlite3* db, void*, int, const char* const*, sqlite3_vtab** vtab, char**) {
+    int rc = sqlite3_declare_vtab(db, "CREATE TABLE x(value, array HIDDEN)");
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    *vtab = static_cast<sqlite3_vtab*>(sqlite3_malloc(sizeof(sqlite3_vtab)));
+    if (*vtab == nullptr) {
+        return SQLITE_NOMEM;
+    }
+    std::memset(*vtab, 0, sizeof(sqlite3_vtab));
+    return SQLITE_OK;
+}
+
+int ArrayDisconnect(sqlite3_vtab* vtab) {
+    sqlite3_free(vtab);
+    return SQLITE_OK;
+}
+
+int ArrayBestIndex(sqlite3_vtab*, sqlite3_index_info* info) {
+    for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& constraint = info->aConstraint[i];
+        if (constraint.usable && constraint.iColumn == ARRAY_COLUMN_ARRAY &&
+            constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+            info->aConstraintUsage[i].argvIndex = 1;
+            info->aConstraintUsage[i].omit = 1;
+            info->idxNum = 1;
+            info->estimatedCost = 1;
+            info->estimatedRows = 100;
+            return SQLITE_OK;
+        }
+    }
+
+    // Without its argument the table is empty; steer the planner away
+    info->idxNum = 0;
+    info->estimatedCost = 2147483647;
+    info->estimatedRows = 2147483647;
+    return SQLITE_OK;
+}
+
+int ArrayOpen(sqlite3_vtab*, sqlite3_vtab_cursor** cursor) {
+    ArrayCursor* arrayCursor = static_cast<ArrayCursor*>(sqlite3_malloc(sizeof(ArrayCursor)));
+    if (arrayCursor == nullptr) {
+        return SQLITE_NOMEM;
+    }
+    std::memset(arrayCursor, 0, sizeof(ArrayCursor));
+    *cursor = &arrayCursor->base;
+    return SQLITE_OK;
+}
+
+int ArrayClose(sqlite3_vtab_cursor* cursor) {
+    sqlite3_free(cursor);
+    return SQLITE_OK;
+}
+
+int ArrayFilter(sqlite3_vtab_cursor* cursor, int idxNum, const char*, int argc, sqlite3_value** argv) {
+    ArrayCursor* arrayCursor = reinterpret_cast<ArrayCursor*>(cursor);
+    arrayCursor->array = idxNum == 1 && argc > 0
+        ? static_cast<const BoundArray*>(sqlite3_value_pointer(argv[0], ARRAY_POINTER_TYPE))
+        : nullptr;
+    arrayCursor->row = 0;
+    return SQLITE_OK;
+}
+
+int ArrayNext(sqlite3_vtab_cursor* cursor) {
+    ++reinterpret_cast<ArrayCursor*>(cursor)->row;
+    return SQLITE_OK;
+}
+
+int ArrayEof(sqlite3_vtab_cursor* cursor) {
+    const ArrayCursor* arrayCursor = reinterpret_cast<const ArrayCursor*>(cursor);
+    return arrayCursor->array == nullptr || arrayCursor->row >= arrayCursor->array->size();
+}
+
+int ArrayColumn(sqlite3_vtab_cursor* cursor, sqlite3_context* context, int column) {
+    const ArrayCursor* arrayCursor = reinterpret_cast<const ArrayCursor*>(cursor);
+    if (column != ARRAY_COLUMN_VALUE) {
+        sqlite3_result_null(context);
+    } else if (!arrayCursor->array->numbers.empty()) {
+        sqlite3_result_int64(context, arrayCursor->array->numbers[arrayCursor->row]);
+    } else {
+        // The bound array outlives the statement's steps
+        const std::string& text = arrayCursor->array->texts[arrayCursor->row];
+        sqlite3_result_text(context, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+    }
+    return SQLITE_OK;
+}
+
+int ArrayRowid(sqlite3_vtab_cursor* cursor, sqlite3_int64* rowid) {
+    *rowid = static_cast<sqlite3_int64>(reinterpret_cast<const ArrayCursor*>(cursor)->row) + 1;
+    return SQLITE_OK;
+}
+
+sqlite3_module MakeArrayModule() {
+    sqlite3_module module;
+    std::memset(&module, 0, sizeof(module));
+    // No xCreate: the table only exists as the eponymous function
+    module.xConnect = ArrayConnect;
+    module.xBestIndex = ArrayBestIndex;
+    module.xDisconnect = ArrayDisconnect;
+    module.xOpen = ArrayOpen;
+    module.xClose = ArrayClose;
+    module.xFilter = ArrayFilter;
+    module.xNext = ArrayNext;
+    module.xEof = ArrayEof;
+    module.xColumn = ArrayColumn;
+    module.xRowid = ArrayRowid;
+    return module;
+}
+
+const sqlite3_module ARRAY_MODULE = MakeArrayModule();
+
+void BindArray(sqlite3_stmt* stmt, int paramIndex, BoundArray* array) {
+    if (stmt == nullptr) {
+        delete array;
+        throw wxSQLite3Exception(SQLITE_ERROR, "Statement not valid");
+    }
+
+    // SQLite owns the array from here on, even when binding fails
+    int rc = sqlite3_bind_pointer(stmt, paramIndex, array, ARRAY_POINTER_TYPE, DeleteBoundArray);
+
+    if (rc != SQLITE_OK) {
+        const char* errmsg = sqlite3_errmsg(sqlite3_db_handle(stmt));
+        throw wxSQLite3Exception(rc, wxString::FromUTF8(errmsg));
+    }
+}
+
+} // namespace
+
 // wxSQLite3Statement implementation
-wxSQLite3Statement::wxSQLite3Statement() : m_stmt(nullptr), m_db(nullptr), m_valid(false) {
+wxSQLite3Statement::wxSQLite3Statement() : m_stmt(nullptr), m_db(nullptr), m_valid(false), m_cached(false) {
 }
 
-wxSQLite3Statement::wxSQLite3Statement(sqlite3_stmt* stmt, wxSQLite3Database* db)
-    : m_stmt(stmt), m_db(db), m_valid(stmt != nullptr) {
+wxSQLite3Statement::wxSQLite3Statement(sqlite3_stmt* stmt, wxSQLite3Database* db, bool cached)
+    : m_stmt(stmt), m_db(db), m_valid(stmt != nullptr), m_cached(cached) {
 }
 
-wxSQLite3Statement::wxSQLite3Statement(const wxSQLite3Statement& statement)
-    : m_stmt(statement.m_stmt), m_db(statement.m_db), m_valid(statement.m_valid) {
+wxSQLite3Statement::wxSQLite3Statement(wxSQLite3Statement&& statement) noexcept
+    : m_stmt(statement.m_stmt), m_db(statement.m_db), m_valid(statement.m_valid),
+      m_cached(statement.m_cached) {
+    statement.m_stmt = nullptr;
+    statement.m_valid = false;
+    statement.m_cached = false;
 }
 
-wxSQLite3Statement& wxSQLite3Statement::operator=(const wxSQLite3Statement& statement) {
+wxSQLite3Statement& wxSQLite3Statement::operator=(wxSQLite3Statement&& statement) noexcept {
     if (this != &statement) {
         Finalize();
         m_stmt = statement.m_stmt;
         m_db = statement.m_db;
         m_valid = statement.m_valid;
+        m_cached = statement.m_cached;
+        statement.m_stmt = nullptr;
+        statement.m_valid = false;
+        statement.m_cached = false;
     }
     return *this;
 }
@@ -26,6 +194,7 @@ wxSQLite3Statement& wxSQLite3Statement::operator=(sqlite3_stmt* stmt) {
     Finalize();
     m_stmt = stmt;
     m_valid = (m_stmt != nullptr);
+    m_cached = false;
     return *this;
 }
 
@@ -45,10 +214,15 @@ void wxSQLite3Statement::Reset() {
 
 void wxSQLite3Statement::Finalize() {
     if (m_stmt != nullptr) {
-        sqlite3_finalize(m_stmt);
+        if (m_cached && m_db != nullptr) {
+            m_db->ReleaseStatement(m_stmt);
+        } else {
+            sqlite3_finalize(m_stmt);
+        }
         m_stmt = nullptr;
     }
     m_valid = false;
+    m_cached = false;
 }
 
 void wxSQLite3Statement::Bind(int paramIndex, const wxString& value) {
@@ -120,6 +294,28 @@ void wxSQLite3Statement::BindNull(int paramIndex) {
     }
 }
 
+void wxSQLite3Statement::Bind(int paramIndex, const std::vector<int64_t>& values) {
+    BoundArray* array = new BoundArray();
+    array->numbers = values;
+    BindArray(m_stmt, paramIndex, array);
+}
+
+void wxSQLite3Statement::Bind(int paramIndex, const std::vector<int>& values) {
+    BoundArray* array = new BoundArray();
+    array->numbers.assign(values.begin(), values.end());
+    BindArray(m_stmt, paramIndex, array);
+}
+
+void wxSQLite3Statement::Bind(int paramIndex, const std::vector<wxString>& values) {
+    BoundArray* array = new BoundArray();
+    array->texts.reserve(values.size());
+    for (const wxString& value : values) {
+        wxCharBuffer strBuffer = value.ToUTF8();
+        array->texts.emplace_back(strBuffer.data(), strBuffer.length());
+    }
+    BindArray(m_stmt, paramIndex, array);
+}
+
 int wxSQLite3Statement::ExecuteUpdate() {
     if (m_stmt == nullptr) {
         throw wxSQLite3Exception(SQLITE_ERROR, "Statement not valid");
@@ -155,17 +351,30 @@ wxSQLite3ResultSet::wxSQLite3ResultSet(sqlite3_stmt* stmt, wxSQLite3Database* db
     : m_stmt(stmt), m_db(db), m_valid(stmt != nullptr), m_eof(false) {
 }
 
-wxSQLite3ResultSet::wxSQLite3ResultSet(const wxSQLite3ResultSet& resultSet)
-    : m_stmt(resultSet.m_stmt), m_db(resultSet.m_db), m_valid(resultSet.m_valid), m_eof(resultSet.m_eof) {
+wxSQLite3ResultSet::wxSQLite3ResultSet(wxSQLite3Statement&& ownedStmt)
+    : m_stmt(ownedStmt.m_stmt), m_db(ownedStmt.m_db), m_ownedStmt(std::move(ownedStmt)),
+      m_valid(m_stmt != nullptr), m_eof(false) {
+}
+
+wxSQLite3ResultSet::wxSQLite3ResultSet(wxSQLite3ResultSet&& resultSet) noexcept
+    : m_stmt(resultSet.m_stmt), m_db(resultSet.m_db), m_ownedStmt(std::move(resultSet.m_ownedStmt)),
+      m_valid(resultSet.m_valid), m_eof(resultSet.m_eof) {
+    resultSet.m_stmt = nullptr;
+    resultSet.m_valid = false;
+    resultSet.m_eof = true;
 }
 
-wxSQLite3ResultSet& wxSQLite3ResultSet::operator=(const wxSQLite3ResultSet& resultSet) {
+wxSQLite3ResultSet& wxSQLite3ResultSet::operator=(wxSQLite3ResultSet&& resultSet) noexcept {
     if (this != &resultSet) {
         Finalize();
         m_stmt = resultSet.m_stmt;
         m_db = resultSet.m_db;
+        m_ownedStmt = std::move(resultSet.m_ownedStmt);
         m_valid = resultSet.m_valid;
         m_eof = resultSet.m_eof;
+        resultSet.m_stmt = nullptr;
+        resultSet.m_valid = false;
+        resultSet.m_eof = true;
     }
     return *this;
 }
@@ -193,7 +402,13 @@ bool wxSQLite3ResultSet::NextRow() {
 }
 
 void wxSQLite3ResultSet::Finalize() {
-    // Note: We don't finalize the statement here because it's owned by the statement object
+    if (m_ownedStmt.IsValid()) {
+        m_ownedStmt.Finalize();
+    } else if (m_stmt != nullptr) {
+        // Borrowed from a statement object that may be re-run; just release
+        // the read cursor. The return code only repeats the last step's error.
+        sqlite3_reset(m_stmt);
+    }
     m_stmt = nullptr;
     m_valid = false;
     m_eof = true;
@@ -222,17 +437,50 @@ wxString wxSQLite3ResultSet::GetColumnName(int columnIndex) const {
 }
 
 wxString wxSQLite3ResultSet::GetAsString(int columnIndex) const {
+    std::string_view text = GetAsStringView(columnIndex);
+    
+    if (text.data() == nullptr) {
+        return wxEmptyString;
+    }
+    
+    return wxString::FromUTF8(text.data(), text.size());
+}
+
+std::string_view wxSQLite3ResultSet::GetAsStringView(int columnIndex) const {
     if (m_stmt == nullptr) {
         throw wxSQLite3Exception(SQLITE_ERROR, "Result set not valid");
     }
     
+    // sqlite3_column_bytes must follow the conversion to get the text length
     const unsigned char* text = sqlite3_column_text(m_stmt, columnIndex);
     
     if (text == nullptr) {
-        return wxEmptyString;
+        return std::string_view();
     }
     
-    return wxString::FromUTF8(reinterpret_cast<const char*>(text));
+    return std::string_view(reinterpret_cast<const char*>(text), sqlite3_column_bytes(m_stmt, columnIndex));
+}
+
+std::string_view wxSQLite3ResultSet::GetAsBlobView(int columnIndex) const {
+    if (m_stmt == nullptr) {
+        throw wxSQLite3Exception(SQLITE_ERROR, "Result set not valid");
+    }
+    
+    const void* blob = sqlite3_column_blob(m_stmt, columnIndex);
+    
+    if (blob == nullptr) {
+        return std::string_view();
+    }
+    
+    return std::string_view(static_cast<const char*>(blob), sqlite3_column_bytes(m_stmt, columnIndex));
+}
+
+int wxSQLite3ResultSet::GetColumnBytes(int columnIndex) const {
+    if (m_stmt == nullptr) {
+        throw wxSQLite3Exception(SQLITE_ERROR, "Result set not valid");
+    }
+    
+    return sqlite3_column_bytes(m_stmt, columnIndex);
 }
 
 int wxSQLite3ResultSet::GetAsInt(int columnIndex) const {
@@ -243,6 +491,14 @@ int wxSQLite3ResultSet::GetAsInt(int columnIndex) const {
     return sqlite3_column_int(m_stmt, columnIndex);
 }
 
+int64_t wxSQLite3ResultSet::GetAsInt64(int columnIndex) const {
+    if (m_stmt == nullptr) {
+        throw wxSQLite3Exception(SQLITE_ERROR, "Result set not valid");
+    }
+    
+    return sqlite3_column_int64(m_stmt, columnIndex);
+}
+
 double wxSQLite3ResultSet::GetAsDouble(int columnIndex) const {
     if (m_stmt == nullptr) {
         throw wxSQLite3Exception(SQLITE_ERROR, "Result set not valid");
@@ -275,7 +531,10 @@ bool wxSQLite3ResultSet::IsNull(int columnIndex) const {
 }
 
 // wxSQLite3Database implementation
-wxSQLite3Database::wxSQLite3Database() : m_db(nullptr), m_isOpen(false) {
+wxSQLite3Database::wxSQLite3Database()
+    : m_db(nullptr), m_isOpen(false), m_profiler(nullptr),
+      m_stmtCacheCapacity(DEFAULT_STATEMENT_CACHE_SIZE),
+      m_stmtCacheHits(0), m_stmtCacheMisses(0) {
 }
 
 wxSQLite3Database::~wxSQLite3Database() {
@@ -297,10 +556,21 @@ void wxSQLite3Database::Open(const wxString& fileName) {
         throw wxSQLite3Exception(rc, errmsg);
     }
     
+    rc = sqlite3_create_module(m_db, "wx_array", &ARRAY_MODULE, nullptr);
+    if (rc != SQLITE_OK) {
+        wxString errmsg = wxString::FromUTF8(sqlite3_errmsg(m_db));
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        throw wxSQLite3Exception(rc, errmsg);
+    }
+    
     m_isOpen = true;
+    SetProfiler(m_profiler.load());
 }
 
 void wxSQLite3Database::Close() {
+    ClearStatementCache();
+    
     if (m_db != nullptr) {
         sqlite3_close(m_db);
         m_db = nullptr;
@@ -308,22 +578,96 @@ void wxSQLite3Database::Close() {
     m_isOpen = false;
 }
 
-wxSQLite3Statement wxSQLite3Database::PrepareStatement(const wxString& sql) {
+sqlite3_stmt* wxSQLite3Database::Prepare(const char* sql) {
     if (m_db == nullptr) {
         throw wxSQLite3Exception(SQLITE_ERROR, "Database not open");
     }
     
-    wxCharBuffer sqlBuffer = sql.ToUTF8();
     sqlite3_stmt* stmt = nullptr;
     
-    int rc = sqlite3_prepare_v2(m_db, sqlBuffer, -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr);
     
     if (rc != SQLITE_OK) {
         wxString errmsg = wxString::FromUTF8(sqlite3_errmsg(m_db));
         throw wxSQLite3Exception(rc, errmsg);
     }
     
-    return wxSQLite3Statement(stmt, this);
+    return stmt;
+}
+
+wxSQLite3Statement wxSQLite3Database::PrepareStatement(const wxString& sql) {
+    wxCharBuffer sqlBuffer = sql.ToUTF8();
+    
+    if (m_stmtCacheCapacity == 0) {
+        return wxSQLite3Statement(Prepare(sqlBuffer), this);
+    }
+    
+    auto found = m_stmtCacheIndex.find(std::string(sqlBuffer.data()));
+    
+    if (found != m_stmtCacheIndex.end()) {
+        // Hand out the idle statement; it goes back into the cache when released
+        sqlite3_stmt* stmt = found->second->stmt;
+        m_stmtCache.erase(found->second);
+        m_stmtCacheIndex.erase(found);
+        m_stmtCacheHits++;
+        return wxSQLite3Statement(stmt, this, true);
+    }
+    
+    m_stmtCacheMisses++;
+    sqlite3_stmt* stmt = Prepare(sqlBuffer);
+    
+    // ReleaseStatement files statements under sqlite3_sql(), which drops
+    // anything after the first statement; only cache when that is the full text
+    bool cacheable = stmt != nullptr && std::strcmp(sqlite3_sql(stmt), sqlBuffer) == 0;
+    return wxSQLite3Statement(stmt, this, cacheable);
+}
+
+void wxSQLite3Database::ReleaseStatement(sqlite3_stmt* stmt) {
+    if (m_db == nullptr || m_stmtCacheCapacity == 0) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    
+    // Leave the statement ready for its next user: no pending step, no bindings.
+    // The return code of sqlite3_reset only repeats the last step's error.
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    
+    std::string sql(sqlite3_sql(stmt));
+    
+    if (m_stmtCacheIndex.count(sql) != 0) {
+        // Another copy of this statement is already idle
+        sqlite3_finalize(stmt);
+        return;
+    }
+    
+    m_stmtCache.push_front(CachedStatement{sql, stmt});
+    m_stmtCacheIndex[sql] = m_stmtCache.begin();
+    
+    TrimStatementCache(m_stmtCacheCapacity);
+}
+
+void wxSQLite3Database::TrimStatementCache(size_t capacity) {
+    while (m_stmtCache.size() > capacity) {
+        CachedStatement& oldest = m_stmtCache.back();
+        sqlite3_finalize(oldest.stmt);
+        m_stmtCacheIndex.erase(oldest.sql);
+        m_stmtCache.pop_back();
+    }
+}
+
+void wxSQLite3Database::SetStatementCacheSize(size_t capacity) {
+    m_stmtCacheCapacity = capacity;
+    TrimStatementCache(capacity);
+}
+
+void wxSQLite3Database::ResetStatementCacheStats() {
+    m_stmtCacheHits = 0;
+    m_stmtCacheMisses = 0;
+}
+
+void wxSQLite3Database::ClearStatementCache() {
+    TrimStatementCache(0);
 }
 
 wxSQLite3ResultSet wxSQLite3Database::ExecuteQuery(const wxString& sql) {
@@ -333,14 +677,8 @@ wxSQLite3ResultSet wxSQLite3Database::ExecuteQuery(const wxString& sql) {
         throw wxSQLite3Exception(SQLITE_ERROR, "Could not prepare statement");
     }
     
-    int rc = sqlite3_step(stmt.m_stmt);
-    
-    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
-        wxString errmsg = wxString::FromUTF8(sqlite3_errmsg(m_db));
-        throw wxSQLite3Exception(rc, errmsg);
-    }
-    
-    return wxSQLite3ResultSet(stmt.m_stmt, this);
+    // The result set takes ownership; the first NextRow() steps to the first row
+    return wxSQLite3ResultSet(std::move(stmt));
 }
 
 
@@ -362,3 +700,249 @@ int wxSQLite3Database::ExecuteUpdate(const wxString& sql) {
     
     return sqlite3_changes(m_db);
 }
+
+
+int64_t wxSQLite3Database::GetLastRowId() const {
+    if (m_db == nullptr) {
+        throw wxSQLite3Exception(SQLITE_ERROR, "Database not open");
+    }
+
+    return sqlite3_last_insert_rowid(m_db);
+}
+
+
+bool wxSQLite3Database::GetAutoCommit() const {
+    return m_db == nullptr || sqlite3_get_autocommit(m_db) != 0;
+}
+
+void wxSQLite3Database::Interrupt() {
+    if (m_db != nullptr) {
+        sqlite3_interrupt(m_db);
+    }
+}
+
+void wxSQLite3Database::SetProgressHandler(int instructions, int (*handler)(void*), void* arg) {
+    if (m_db != nullptr) {
+        sqlite3_progress_handler(m_db, instructions, handler, arg);
+    }
+}
+
+void wxSQLite3Database::SetProfiler(wxSQLite3Profiler* profiler) {
+    m_profiler = profiler;
+    if (m_db != nullptr) {
+        sqlite3_trace_v2(m_db,
+                         profiler != nullptr ? SQLITE_TRACE_STMT | SQLITE_TRACE_ROW | SQLITE_TRACE_PROFILE : 0,
+                         profiler != nullptr ? &wxSQLite3Profiler::OnTrace : nullptr, profiler);
+    }
+}
+
+// wxSQLite3Profiler implementation
+int wxSQLite3Profiler::OnTrace(unsigned type, void* profiler, void* p, void* x) {
+    wxSQLite3Profiler* self = static_cast<wxSQLite3Profiler*>(profiler);
+    sqlite3_stmt* stmt = static_cast<sqlite3_stmt*>(p);
+
+    if (type == SQLITE_TRACE_STMT) {
+        // Also reported when a trigger starts; the run started earlier
+        std::lock_guard<std::mutex> lock(self->m_mutex);
+        self->m_running.emplace(stmt, Run{std::chrono::steady_clock::now(), 0});
+    } else if (type == SQLITE_TRACE_ROW) {
+        // Rows of a run whose start was missed are not counted: a Run made
+        // here would have no start time, and the next run of the statement
+        // would be timed from the epoch
+        std::lock_guard<std::mutex> lock(self->m_mutex);
+        auto running = self->m_running.find(stmt);
+        if (running != self->m_running.end()) {
+            ++running->second.rows;
+        }
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        self->Record(stmt, *static_cast<sqlite3_int64*>(x));
+    }
+    return 0;
+}
+
+void wxSQLite3Profiler::Record(sqlite3_stmt* stmt, int64_t sqliteNs) {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    // Reset so that the next run of a cached statement counts afresh
+    int fullScanSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    int sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+    int autoIndexes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    const char* rawSql = sqlite3_sql(stmt);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto normalized = m_normalized.find(rawSql != nullptr ? rawSql : "");
+    if (normalized == m_normalized.end()) {
+        // SQL built with literals is seldom seen twice; do not keep it all
+        if (m_normalized.size() >= NORMALIZED_CACHE_SIZE) {
+            m_normalized.clear();
+        }
+        normalized = m_normalized.emplace(rawSql != nullptr ? rawSql : "",
+                                          NormalizeSql(rawSql != nullptr ? rawSql : "")).first;
+    }
+    Entry& entry = m_entries[normalized->second];
+
+    // SQLite's own time only when the start was missed, e.g. when the
+    // profiler was attached in the middle of the run
+    int64_t ns = sqliteNs;
+    int64_t rows = 0;
+    auto running = m_running.find(stmt);
+    if (running != m_running.end()) {
+        ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - running->second.start).count();
+        rows = running->second.rows;
+        m_running.erase(running);
+    }
+
+    if (entry.count == 0 || ns < entry.minNs) {
+        entry.minNs = ns;
+    }
+    entry.maxNs = std::max(entry.maxNs, ns);
+    ++entry.count;
+    entry.totalNs += ns;
+    entry.fullScanSteps += fullScanSteps;
+    entry.sorts += sorts;
+    entry.autoIndexes += autoIndexes;
+    entry.rows += rows;
+
+    int bucket = 0;
+    if (ns > 1000) {
+        bucket = static_cast<int>(std::log2(ns / 1000.0) * BUCKETS_PER_DOUBLING);
+        bucket = std::min(bucket, HISTOGRAM_BUCKETS - 1);
+    }
+    ++entry.histogram[bucket];
+}
+
+double wxSQLite3Profiler::Percentile(const Entry& entry, double fraction) const {
+    unsigned long rank = static_cast<unsigned long>(std::ceil(entry.count * fraction));
+    unsigned long seen = 0;
+    int bucket = 0;
+    for (; bucket < HISTOGRAM_BUCKETS - 1; ++bucket) {
+        seen += entry.histogram[bucket];
+        if (seen >= rank) {
+            break;
+        }
+    }
+
+    // Geometric middle of the bucket, kept within the times seen
+    double us = std::pow(2.0, (bucket + 0.5) / BUCKETS_PER_DOUBLING);
+    double ms = std::min(std::max(us / 1000.0, entry.minNs / 1e6), entry.maxNs / 1e6);
+    return ms;
+}
+
+std::vector<wxSQLite3QueryStats> wxSQLite3Profiler::GetStats() const {
+    std::vector<wxSQLite3QueryStats> stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.reserve(m_entries.size());
+        for (const auto& item : m_entries) {
+            const Entry& entry = item.second;
+            wxSQLite3QueryStats query;
+            query.sql = wxString::FromUTF8(item.first.c_str());
+            query.count = entry.count;
+            query.totalMs = entry.totalNs / 1e6;
+            query.minMs = entry.minNs / 1e6;
+            query.maxMs = entry.maxNs / 1e6;
+            query.p50Ms = Percentile(entry, 0.50);
+            query.p95Ms = Percentile(entry, 0.95);
+            query.p99Ms = Percentile(entry, 0.99);
+            query.rows = entry.rows;
+            query.fullScanSteps = entry.fullScanSteps;
+            query.sorts = entry.sorts;
+            query.autoIndexes = entry.autoIndexes;
+            stats.push_back(query);
+        }
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const wxSQLite3QueryStats& a, const wxSQLite3QueryStats& b) {
+        return a.totalMs > b.totalMs;
+    });
+    return stats;
+}
+
+void wxSQLite3Profiler::Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    // Statements still running keep counting their rows
+}
+
+wxString wxSQLite3Profiler::Format() const {
+    std::vector<wxSQLite3QueryStats> stats = GetStats();
+
+    wxString text = wxString::Format("%8s %10s %9s %9s %9s %9s %9s %9s %10s %6s %7s  %s\n",
+                                     "calls", "total ms", "min ms", "p50 ms", "p95 ms", "p99 ms", "max ms",
+                                     "rows", "fullscan", "sorts", "autoidx", "sql");
+    for (const wxSQLite3QueryStats& query : stats) {
+        text += wxString::Format("%8lu %10.2f %9.3f %9.3f %9.3f %9.3f %9.3f %9lld %10lld %6lld %7lld  %s\n",
+                                 query.count, query.totalMs, query.minMs, query.p50Ms, query.p95Ms,
+                                 query.p99Ms, query.maxMs, static_cast<long long>(query.rows),
+                                 static_cast<long long>(query.fullScanSteps),
+                                 static_cast<long long>(query.sorts),
+                                 static_cast<long long>(query.autoIndexes), query.sql);
+    }
+    return text;
+}
+
+std::string wxSQLite3Profiler::NormalizeSql(const char* sql) {
+    std::string normalized;
+    normalized.reserve(std::strlen(sql));
+
+    auto isWordChar = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' ||
+               (static_cast<unsigned char>(c) & 0x80) != 0;
+    };
+
+    const char* p = sql;
+    while (*p != '\0') {
+        char c = *p;
+        bool afterWord = !normalized.empty() && isWordChar(normalized.back());
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            while (std::isspace(static_cast<unsigned char>(*p))) {
+                ++p;
+            }
+            if (!normalized.empty() && *p != '\0') {
+                normalized += ' ';
+            }
+        } else if (c == '\'' || ((c == 'x' || c == 'X') && p[1] == '\'' && !afterWord)) {
+            // String or blob literal; '' is a quote inside it
+            p += c == '\'' ? 1 : 2;
+            while (*p != '\0' && !(*p == '\'' && p[1] != '\'')) {
+                p += *p == '\'' ? 2 : 1;
+            }
+            if (*p != '\0') {
+                ++p;
+            }
+            normalized += '?';
+        } else if (c == '"' || c == '`' || c == '[') {
+            // Quoted identifier, kept as written
+            char close = c == '[' ? ']' : c;
+            normalized += *p++;
+            while (*p != '\0' && *p != close) {
+                normalized += *p++;
+            }
+            if (*p != '\0') {
+                normalized += *p++;
+            }
+        } else if (c == '?') {
+            // Numbered parameters such as ?1 stay as they are
+            normalized += *p++;
+            while (std::isdigit(static_cast<unsigned char>(*p))) {
+                normalized += *p++;
+            }
+        } else if (!afterWord && (std::isdigit(static_cast<unsigned char>(c)) ||
+                                  (c == '.' && std::isdigit(static_cast<unsigned char>(p[1]))))) {
+            // Number, including hex, decimals and exponents
+            while (isWordChar(*p) || *p == '.' ||
+                   ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E'))) {
+                ++p;
+            }
+            normalized += '?';
+        } else {
+            normalized += *p++;
+        }
+    }
+
+    while (!normalized.empty() && normalized.back() == ' ') {
+        normalized.pop_back();
+    }
+    return normalized;
+}
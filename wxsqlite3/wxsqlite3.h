@@ -10,13 +10,23 @@
 
 #include <sqlite3.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
 #include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 // Forward declarations
 class wxSQLite3Database;
 class wxSQLite3Statement;
 class wxSQLite3ResultSet;
+class wxSQLite3Profiler;
 
 // Exception class
 class wxSQLite3Exception {
@@ -32,11 +42,71 @@ public:
     wxString GetMessage() const { return m_errorMessage; }
 };
 
+// Statement class
+//
+// Statements are move-only handles: exactly one wxSQLite3Statement owns a
+// given sqlite3_stmt and finalizes (or returns it to the statement cache)
+// when it is destroyed. A prepared statement can be kept alive and re-run
+// with Reset() + Bind() without preparing it again.
+//
+// An array parameter is read through the wx_array table-valued function,
+// which every connection opened by wxSQLite3Database registers:
+//
+//     SELECT ... FROM tasks WHERE id IN wx_array(?1)
+//     SELECT value FROM wx_array(?1)
+//
+// so one prepared statement serves any number of values. The statement
+// keeps its own copy of the values until they are rebound or cleared.
+class wxSQLite3Statement {
+private:
+    sqlite3_stmt* m_stmt;
+    wxSQLite3Database* m_db;
+    bool m_valid;
+    bool m_cached;  // Returned to the database's statement cache instead of finalized
+
+    friend class wxSQLite3Database;
+    friend class wxSQLite3ResultSet;
+
+    wxSQLite3Statement(sqlite3_stmt* stmt, wxSQLite3Database* db, bool cached = false);
+
+public:
+    wxSQLite3Statement();
+    wxSQLite3Statement(const wxSQLite3Statement&) = delete;
+    wxSQLite3Statement& operator=(const wxSQLite3Statement&) = delete;
+    wxSQLite3Statement(wxSQLite3Statement&& statement) noexcept;
+    wxSQLite3Statement& operator=(wxSQLite3Statement&& statement) noexcept;
+    virtual ~wxSQLite3Statement();
+
+    bool IsValid() const { return m_valid; }
+    void Reset();
+    void Finalize();
+
+    void Bind(int paramIndex, const wxString& value);
+    void Bind(int paramIndex, int value);
+    void Bind(int paramIndex, double value);
+    void Bind(int paramIndex, const wxDateTime& value);
+    void BindNull(int paramIndex);
+    // Array parameters for wx_array; see above
+    void Bind(int paramIndex, const std::vector<int64_t>& values);
+    void Bind(int paramIndex, const std::vector<int>& values);
+    void Bind(int paramIndex, const std::vector<wxString>& values);
+
+    int ExecuteUpdate();
+    // The returned result set borrows this statement, which must outlive it
+    wxSQLite3ResultSet ExecuteQuery();
+    wxSQLite3Statement& operator=(sqlite3_stmt* stmt);
+};
+
 // Result set class
+//
+// A result set either borrows the statement it was produced from
+// (wxSQLite3Statement::ExecuteQuery) and resets it when finished, or owns
+// it outright (wxSQLite3Database::ExecuteQuery). Move-only.
 class wxSQLite3ResultSet {
 private:
     sqlite3_stmt* m_stmt;
     wxSQLite3Database* m_db;
+    wxSQLite3Statement m_ownedStmt;  // Valid only when the result set owns its statement
     bool m_valid;
     bool m_eof;
 
@@ -44,11 +114,14 @@ private:
     friend class wxSQLite3Statement;
 
     wxSQLite3ResultSet(sqlite3_stmt* stmt, wxSQLite3Database* db);
+    explicit wxSQLite3ResultSet(wxSQLite3Statement&& ownedStmt);
 
 public:
     wxSQLite3ResultSet();
-    wxSQLite3ResultSet(const wxSQLite3ResultSet& resultSet);
-    wxSQLite3ResultSet& operator=(const wxSQLite3ResultSet& resultSet);
+    wxSQLite3ResultSet(const wxSQLite3ResultSet&) = delete;
+    wxSQLite3ResultSet& operator=(const wxSQLite3ResultSet&) = delete;
+    wxSQLite3ResultSet(wxSQLite3ResultSet&& resultSet) noexcept;
+    wxSQLite3ResultSet& operator=(wxSQLite3ResultSet&& resultSet) noexcept;
     virtual ~wxSQLite3ResultSet();
 
     bool IsValid() const { return m_valid; }
@@ -60,51 +133,135 @@ public:
     wxString GetColumnName(int columnIndex) const;
     wxString GetAsString(int columnIndex) const;
     int GetAsInt(int columnIndex) const;
+    int64_t GetAsInt64(int columnIndex) const;
     double GetAsDouble(int columnIndex) const;
     wxDateTime GetAsDateTime(int columnIndex) const;
     bool GetAsBool(int columnIndex) const;
     bool IsNull(int columnIndex) const;
-};
 
-// Statement class
-class wxSQLite3Statement {
-private:
-    sqlite3_stmt* m_stmt;
-    wxSQLite3Database* m_db;
-    bool m_valid;
-
-    friend class wxSQLite3Database;
+    // Zero-copy access to the current row. The views point into SQLite's
+    // row buffer and are only valid until the next NextRow(), Finalize() or
+    // another accessor call that converts the same column to a different
+    // type. NULL columns yield an empty view with a null data() pointer.
+    std::string_view GetAsStringView(int columnIndex) const;  // UTF-8 text
+    std::string_view GetAsBlobView(int columnIndex) const;    // raw bytes
+    int GetColumnBytes(int columnIndex) const;
+};
 
-    wxSQLite3Statement(sqlite3_stmt* stmt, wxSQLite3Database* db);
+// Runs of one statement, as aggregated by wxSQLite3Profiler
+struct wxSQLite3QueryStats {
+    wxString sql;           // Literals replaced by ?, whitespace collapsed
+    unsigned long count;
+    double totalMs;
+    double minMs;
+    double maxMs;
+    // Read from a histogram with four buckets per doubling, so within
+    // about 10% of the exact value
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    int64_t rows;           // Rows returned
+    // sqlite3_stmt_status counters, summed over the runs
+    int64_t fullScanSteps;  // SQLITE_STMTSTATUS_FULLSCAN_STEP
+    int64_t sorts;          // SQLITE_STMTSTATUS_SORT
+    int64_t autoIndexes;    // SQLITE_STMTSTATUS_AUTOINDEX: rows put in automatic indexes
+};
 
+// Opt-in statement profiler built on sqlite3_trace_v2. Attached to
+// connections with wxSQLite3Database::SetProfiler, it times every
+// statement they run and aggregates the runs per normalized SQL text, so
+// that the same query with different literals counts as one. A run lasts
+// from its first step to its end, including the time the caller spends
+// between rows. It is timed here with a steady clock: the time
+// SQLITE_TRACE_PROFILE reports has millisecond resolution on Unix.
+// Connections on different threads may share a profiler; it must outlive
+// them or be detached from them first.
+class wxSQLite3Profiler {
 public:
-    wxSQLite3Statement();
-    wxSQLite3Statement(const wxSQLite3Statement& statement);
-    wxSQLite3Statement& operator=(const wxSQLite3Statement& statement);
-    virtual ~wxSQLite3Statement();
+    static const int BUCKETS_PER_DOUBLING = 4;
+    static const int HISTOGRAM_BUCKETS = 27 * BUCKETS_PER_DOUBLING;  // 1 us to 134 s
+    static const size_t NORMALIZED_CACHE_SIZE = 1024;
 
-    bool IsValid() const { return m_valid; }
+    wxSQLite3Profiler() {}
+    wxSQLite3Profiler(const wxSQLite3Profiler&) = delete;
+    wxSQLite3Profiler& operator=(const wxSQLite3Profiler&) = delete;
+
+    // Most total time first
+    std::vector<wxSQLite3QueryStats> GetStats() const;
     void Reset();
-    void Finalize();
+    // GetStats as a plain-text table, for a file or a dialog
+    wxString Format() const;
 
-    void Bind(int paramIndex, const wxString& value);
-    void Bind(int paramIndex, int value);
-    void Bind(int paramIndex, double value);
-    void Bind(int paramIndex, const wxDateTime& value);
-    void BindNull(int paramIndex);
+    // SQL with string, blob and number literals replaced by ? and runs of
+    // whitespace by one space
+    static std::string NormalizeSql(const char* sql);
 
-    int ExecuteUpdate();
-    wxSQLite3ResultSet ExecuteQuery();
-    wxSQLite3Statement& operator=(sqlite3_stmt* stmt);
+private:
+    struct Entry {
+        unsigned long count = 0;
+        int64_t totalNs = 0;
+        int64_t minNs = 0;
+        int64_t maxNs = 0;
+        int64_t rows = 0;
+        int64_t fullScanSteps = 0;
+        int64_t sorts = 0;
+        int64_t autoIndexes = 0;
+        std::array<unsigned long, HISTOGRAM_BUCKETS> histogram{};
+    };
+
+    mutable std::mutex m_mutex;   // Guards the members below
+    std::unordered_map<std::string, Entry> m_entries;             // By normalized SQL
+    std::unordered_map<std::string, std::string> m_normalized;    // Raw SQL to normalized
+    // A statement run in progress
+    struct Run {
+        std::chrono::steady_clock::time_point start;
+        int64_t rows;
+    };
+    std::unordered_map<sqlite3_stmt*, Run> m_running;
+
+    friend class wxSQLite3Database;
+    static int OnTrace(unsigned type, void* profiler, void* p, void* x);
+    void Record(sqlite3_stmt* stmt, int64_t sqliteNs);
+    double Percentile(const Entry& entry, double fraction) const;
 };
 
 // Database class
+//
+// Statements handed out by PrepareStatement come from a small LRU cache keyed
+// by SQL text. When a cached statement is finalized (or goes out of scope) it
+// is reset, its bindings are cleared and it is parked in the cache for the
+// next PrepareStatement call with the same SQL, so hot queries skip
+// sqlite3_prepare_v2. A capacity of 0 disables caching. Statements must not
+// outlive the database object they were prepared on.
 class wxSQLite3Database {
 private:
+    struct CachedStatement {
+        std::string sql;
+        sqlite3_stmt* stmt;
+    };
+    typedef std::list<CachedStatement> StatementList;
+
     sqlite3* m_db;
     bool m_isOpen;
+    // Read by the threads that switch the profilers of a connection pool
+    std::atomic<wxSQLite3Profiler*> m_profiler;
+
+    // Idle statements, most recently used first
+    StatementList m_stmtCache;
+    std::unordered_map<std::string, StatementList::iterator> m_stmtCacheIndex;
+    size_t m_stmtCacheCapacity;
+    unsigned long m_stmtCacheHits;
+    unsigned long m_stmtCacheMisses;
+
+    friend class wxSQLite3Statement;
+
+    sqlite3_stmt* Prepare(const char* sql);
+    void ReleaseStatement(sqlite3_stmt* stmt);
+    void TrimStatementCache(size_t capacity);
 
 public:
+    static const size_t DEFAULT_STATEMENT_CACHE_SIZE = 32;
+
     wxSQLite3Database();
     virtual ~wxSQLite3Database();
 
@@ -115,8 +272,34 @@ public:
     wxSQLite3Statement PrepareStatement(const wxString& sql);
     wxSQLite3ResultSet ExecuteQuery(const wxString& sql);
     int ExecuteUpdate(const wxString& sql);
+
+    // False while a transaction is open on this connection
+    bool GetAutoCommit() const;
+    // Rowid of the most recent successful INSERT on this connection
+    int64_t GetLastRowId() const;
+    // Aborts the statements running on this connection, which then fail
+    // with SQLITE_INTERRUPT. Safe to call from any thread.
+    void Interrupt();
+    // Calls handler about every instructions virtual machine steps while a
+    // statement runs on this connection; a non-zero return interrupts the
+    // statement. A null handler removes it.
+    void SetProgressHandler(int instructions, int (*handler)(void*), void* arg);
+    // Starts recording the statements of this connection in profiler, or
+    // stops with a null one; kept when the database is opened again. Safe
+    // to call while another thread uses the connection.
+    void SetProfiler(wxSQLite3Profiler* profiler);
+    wxSQLite3Profiler* GetProfiler() const { return m_profiler.load(); }
     
     sqlite3* GetDatabaseHandle() const { return m_db; }
+
+    // Statement cache
+    void SetStatementCacheSize(size_t capacity);
+    size_t GetStatementCacheSize() const { return m_stmtCacheCapacity; }
+    size_t GetCachedStatementCount() const { return m_stmtCache.size(); }
+    unsigned long GetStatementCacheHits() const { return m_stmtCacheHits; }
+    unsigned long GetStatementCacheMisses() const { return m_stmtCacheMisses; }
+    void ResetStatementCacheStats();
+    void ClearStatementCache();
 };
 
 